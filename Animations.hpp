@@ -0,0 +1,38 @@
+/* Generated by tools/animenc.py from the animations/ sources, do not edit */
+
+#pragma once
+#include "MatrixAnimator.hpp"
+
+/* attract.txt: 4 frames, 30 bytes (32 raw) */
+static const u8 ATTRACT_DATA[] PROGMEM = {
+    0x18, 0xff, 0xff, 0xff, 0x03, 0x07, 0x0e, 0xe3,
+    0xc7, 0x70, 0xe0, 0xc0, 0xff, 0x1b, 0x1f, 0x16,
+    0x04, 0x20, 0x68, 0xf8, 0xd8, 0xff, 0xd8, 0xf8,
+    0x68, 0x20, 0x04, 0x16, 0x1f, 0x1b,
+};
+static constexpr MatrixAnimator::Animation ATTRACT = {
+    ATTRACT_DATA, 4, 125, true,
+};
+
+/* game_over.txt: 11 frames, 27 bytes (88 raw) */
+static const u8 GAME_OVER_DATA[] PROGMEM = {
+    0xff, 0x81, 0x42, 0x24, 0x18, 0x18, 0x24, 0x42,
+    0x81, 0x00, 0x00, 0x01, 0x81, 0x02, 0x42, 0x04,
+    0x24, 0x08, 0x18, 0x10, 0x18, 0x20, 0x24, 0x40,
+    0x42, 0x80, 0x81,
+};
+static constexpr MatrixAnimator::Animation GAME_OVER = {
+    GAME_OVER_DATA, 11, 125, false,
+};
+
+/* level_complete.txt: 6 frames, 40 bytes (48 raw) */
+static const u8 LEVEL_COMPLETE_DATA[] PROGMEM = {
+    0x18, 0x18, 0x18, 0x3c, 0x3c, 0x3c, 0x3c, 0x3c,
+    0x7e, 0x7e, 0x7e, 0x66, 0x66, 0x7e, 0x7e, 0xff,
+    0xff, 0xff, 0xc3, 0xc3, 0xc3, 0xc3, 0xff, 0xff,
+    0x7e, 0x7e, 0x7e, 0x7e, 0x7e, 0x7e, 0x7e, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+static constexpr MatrixAnimator::Animation LEVEL_COMPLETE = {
+    LEVEL_COMPLETE_DATA, 6, 83, false,
+};
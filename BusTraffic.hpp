@@ -0,0 +1,50 @@
+#pragma once
+#include "LedControl.h"
+#include "utils.hpp"
+
+/*
+ *  Drop-in replacement for the matrix driver that counts the bytes it puts on the bus (the LCD
+ *  drivers count theirs, see Lcd.hpp). The counter only ever increases (modulo 2^16); users
+ *  take the difference between two reads.
+ *
+ *  The methods shadow the driver's ones instead of overriding them, so the matrix must be
+ *  used through this type for its traffic to be counted.
+ */
+
+class MatrixBus : public LedControl {
+public:
+    using LedControl::LedControl;
+
+    void setLed(const int addr, const int row, const int col, const bool state)
+    {
+        bytes += WORD_SIZE;
+        LedControl::setLed(addr, row, col, state);
+    }
+    void setRow(const int addr, const int row, const u8 value)
+    {
+        bytes += WORD_SIZE;
+        LedControl::setRow(addr, row, value);
+    }
+    void clearDisplay(const int addr)
+    {
+        bytes += NUM_ROWS * WORD_SIZE;
+        LedControl::clearDisplay(addr);
+    }
+    void setIntensity(const int addr, const int intensity)
+    {
+        bytes += WORD_SIZE;
+        LedControl::setIntensity(addr, intensity);
+    }
+    void shutdown(const int addr, const bool status)
+    {
+        bytes += WORD_SIZE;
+        LedControl::shutdown(addr, status);
+    }
+
+    /* Every MAX7219 command is a 16-bit word, `clearDisplay` writes all the rows */
+    static constexpr u8 WORD_SIZE = 2;
+    static constexpr u8 NUM_ROWS = 8;
+
+public:
+    u16 bytes = 0;
+};
@@ -0,0 +1,139 @@
+#include "Buzzer.hpp"
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+/*
+ *  Single producer (the main loop) and single consumer (the interrupt) for the queue.
+ *  Everything else the main loop shares with the interrupt is either a flag or written with
+ *  interrupts disabled.
+ */
+constexpr u16 Buzzer::PRESCALERS[];
+
+/* Function declarations */
+static void advance();
+static void start(const Buzzer::Note&);
+
+static BOARD_LOCAL Tiny::SpscQueue<const Buzzer::Effect*, Buzzer::QUEUE_SIZE> queue;
+
+static BOARD_LOCAL const Buzzer::Effect* volatile effect = nullptr;
+static BOARD_LOCAL u8 noteIdx;
+static BOARD_LOCAL Buzzer::Note background;
+static BOARD_LOCAL u16 remaining;
+
+/* Set by the main loop for the interrupt to move on before the current effect note ends */
+static BOARD_LOCAL volatile bool wake = false;
+static BOARD_LOCAL volatile bool preempt = false;
+static BOARD_LOCAL volatile u8 preemptPriority;
+
+/* The timer toggles OC2B by itself, this only decides when the next note starts */
+ISR(TIMER2_COMPA_vect)
+{
+    if (--remaining && !wake)
+        return;
+
+    wake = false;
+    advance();
+}
+
+void Buzzer::init()
+{
+    pinMode(PIN, OUTPUT);
+    digitalWrite(PIN, LOW);
+
+    background = note(0, 0);
+    start(background);
+}
+
+bool Buzzer::play(const Effect& newEffect)
+{
+    /* Repeated input queues an effect once, instead of restarting it on every frame */
+    if (!queue.empty() && queue.back() == &newEffect)
+        return true;
+    if (!queue.push(&newEffect))
+        return false;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        /* With no effect playing, the interrupt is off and this starts the new one itself */
+        const auto current = effect;
+        if (current == nullptr) {
+            advance();
+        } else if (newEffect.priority > current->priority) {
+            preemptPriority = newEffect.priority;
+            preempt = true;
+            wake = true;
+        }
+    }
+
+    return true;
+}
+
+void Buzzer::setBackground(const u16 freq)
+{
+    const auto newBackground = note(freq, 0);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        background = newBackground;
+        if (effect == nullptr)
+            start(background);
+    }
+}
+
+void Buzzer::silence()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        queue.clear();
+        effect = nullptr;
+        background = note(0, 0);
+        start(background);
+    }
+}
+
+void advance()
+{
+    if (preempt) {
+        preempt = false;
+        effect = nullptr;
+        while (!queue.empty() && queue.front()->priority < preemptPriority)
+            queue.drop();
+    }
+
+    const auto current = effect;
+    if (current != nullptr && ++noteIdx < current->numNotes) {
+        start(Tiny::readPgm(&current->notes[noteIdx]));
+        return;
+    }
+
+    const Buzzer::Effect* next;
+    if (queue.pop(next)) {
+        effect = next;
+        noteIdx = 0;
+        start(Tiny::readPgm(&next->notes[0]));
+        return;
+    }
+
+    effect = nullptr;
+    start(background);
+}
+
+/*
+ *  Only notes that end need the interrupt. The background one (0 half periods) plays on the
+ *  timer alone, so the interrupt does not fire at its rate for nothing.
+ */
+void start(const Buzzer::Note& note)
+{
+    TIMSK2 = 0;
+    TCCR2A = u8(_BV(WGM21) | (note.audible ? _BV(COM2B0) : 0));
+    TCCR2B = note.clockSelect;
+    OCR2A = note.top;
+    OCR2B = 0;
+    TCNT2 = 0;
+    remaining = note.halfPeriods;
+
+    if (note.halfPeriods) {
+        TIFR2 = _BV(OCF2A);
+        TIMSK2 = _BV(OCIE2A);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "utils.hpp"
+
+/*
+ *  Buzzer driven by Timer 2, whose OC2B output is the buzzer pin. The timer toggles the pin by
+ *  itself; its compare interrupt only counts half periods, to end a note and start the next,
+ *  and is off while the background note plays.
+ *
+ *  Sound effects are short note sequences with a priority. `play` queues one in constant time
+ *  and the interrupt plays the queue in order; an effect with a higher priority than the one
+ *  playing cuts it short, along with the lower priority ones queued before it. With no effect
+ *  left, the buzzer goes back to the background note (the melody, see `setBackground`).
+ *
+ *  This owns TIMER2_COMPA_vect, so the sketch must not use `tone()`.
+ */
+struct Buzzer {
+public:
+    struct Note {
+        u8 clockSelect;
+        u8 top;
+        bool audible;
+        u16 halfPeriods;
+    };
+    struct Effect {
+        /* In program memory, built with `note` */
+        const Note* notes;
+        u8 numNotes;
+        u8 priority;
+    };
+
+    static void init();
+    static bool play(const Effect&);
+    static void setBackground(u16 freq);
+    static void silence();
+
+    /* Timer settings for `freq` (0 for a rest) held for `ms` */
+    static constexpr Note note(const u16 freq, const u16 ms)
+    {
+        return freq ? makeNote(halfPeriodClocks(freq), ms, true)
+                    : makeNote(REST_CLOCKS, ms, false);
+    }
+
+    static constexpr u8 PIN = 3;
+    static constexpr u8 QUEUE_SIZE = 4;
+
+private:
+    static constexpr u32 halfPeriodClocks(const u16 freq) { return F_CPU / 2 / freq; }
+
+    /* The smallest prescaler that brings the compare value within 8 bits */
+    static constexpr u8 prescalerIdx(const u32 clocks, const u8 i = 0)
+    {
+        return i == NUM_PRESCALERS - 1 || clocks / PRESCALERS[i] <= 256
+            ? i
+            : prescalerIdx(clocks, u8(i + 1));
+    }
+
+    static constexpr Note makeNote(const u32 clocks, const u16 ms, const bool audible)
+    {
+        return makeNote(clocks, ms, audible, PRESCALERS[prescalerIdx(clocks)]);
+    }
+
+    static constexpr Note makeNote(
+        const u32 clocks, const u16 ms, const bool audible, const u16 prescaler)
+    {
+        return {
+            u8(prescalerIdx(clocks) + 1),
+            u8(clocks / prescaler - 1),
+            audible,
+            u16(u32(ms) * (F_CPU / 1000) / (clocks / prescaler * prescaler)),
+        };
+    }
+
+    static constexpr u8 NUM_PRESCALERS = 7;
+    static constexpr u16 PRESCALERS[NUM_PRESCALERS] = { 1, 8, 32, 64, 128, 256, 1024 };
+
+    /* Rests keep the interrupt running at 2 kHz to time them */
+    static constexpr u32 REST_CLOCKS = F_CPU / 2000;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include "utils.hpp"
+
+/*
+ *  Stackless coroutines (protothreads) for the state update functions, so that a sequence
+ *  spread over many frames ("show a tile, wait, show the next one") reads as straight code.
+ *
+ *  The body of the update function goes between `CO_BEGIN` and `CO_END`, which wrap it in a
+ *  `switch` on the resume point. A suspension saves the number of the point to continue from
+ *  in the `Coroutine`, which lives in the state params, and returns; the next frame's call
+ *  goes right back there through the `switch`. The points of a function are numbered from 1
+ *  up, so that the compiler can make the `switch` a jump table: resuming then costs a bound
+ *  check and an indexed jump, whatever the number of suspension points (see
+ *  tests/coroutine_test.cpp). A zeroed `Coroutine`, as in freshly made state params, starts
+ *  from the beginning.
+ *
+ *  Being stackless, a coroutine keeps nothing but the resume point across a suspension:
+ *  - locals must not be used past a suspension point, anything longer lived goes in the
+ *    state params (locals computed before `CO_BEGIN` are fine, they are redone every frame);
+ *  - a suspension point can't be inside a `switch` of the body, whose cases it would join;
+ *  - the body must not run off its end, which would resume past its last suspension point:
+ *    it loops until it changes the state.
+ */
+struct Coroutine {
+public:
+    /* The suspension point to continue from, 0 to start */
+    u8 resume;
+    u32 waitTs;
+};
+
+#define CO_BEGIN(co)                                                                          \
+    enum : u8 { CO_BASE = __COUNTER__ };                                                      \
+    switch ((co).resume) {                                                                    \
+    case 0:
+
+#define CO_END                                                                                \
+    default:                                                                                  \
+        UNREACHABLE;                                                                          \
+    }
+
+/* The next suspension point of the function, as a constant */
+#define CO_POINT (__COUNTER__ - CO_BASE)
+
+/* Gives up the rest of the frame */
+#define CO_YIELD(co) CO_YIELD_(co, CO_POINT)
+#define CO_YIELD_(co, point)                                                                  \
+    do {                                                                                      \
+        (co).resume = u8(point);                                                              \
+        return;                                                                               \
+    case point:;                                                                              \
+    } while (0)
+
+/* Checks `cond` every frame from this one on, until it holds */
+#define CO_AWAIT(co, cond) CO_AWAIT_(co, cond, CO_POINT)
+#define CO_AWAIT_(co, cond, point)                                                            \
+    do {                                                                                      \
+        (co).resume = u8(point);                                                              \
+        __attribute__((fallthrough));                                                         \
+    case point:                                                                               \
+        if (!(cond))                                                                          \
+            return;                                                                           \
+    } while (0)
+
+/* Waits `ms` from the frame at `nowTs`, as timestamped by the frames resuming it */
+#define CO_AWAIT_MS(co, nowTs, ms)                                                            \
+    do {                                                                                      \
+        (co).waitTs = (nowTs);                                                                \
+        CO_AWAIT(co, (nowTs) - (co).waitTs >= (ms));                                          \
+    } while (0)
+
+/* Waits for the next frame with a press or a direction in `input` */
+#define CO_AWAIT_INPUT(co, input) CO_AWAIT_INPUT_(co, input, CO_POINT)
+#define CO_AWAIT_INPUT_(co, input, point)                                                     \
+    do {                                                                                      \
+        (co).resume = u8(point);                                                              \
+        return;                                                                               \
+    case point:                                                                               \
+        if (!u8((input).joyPress) && !u8((input).joyDir))                                     \
+            return;                                                                           \
+    } while (0)
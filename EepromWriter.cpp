@@ -0,0 +1,133 @@
+#include "EepromWriter.hpp"
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+/*
+ *  The main loop only touches the queue while the interrupt is masked (`pause`), so the two
+ *  never run over it at the same time. A write already started by the hardware goes on.
+ */
+struct Intent {
+    u16 addr;
+    const u8* src;
+    u8 size;
+};
+
+/* Function declarations */
+static void pause();
+static void resume();
+static u8 next(u8);
+
+static BOARD_LOCAL Intent queue[EepromWriter::QUEUE_SIZE];
+static BOARD_LOCAL volatile u8 queueHead = 0;
+static BOARD_LOCAL volatile u8 queueTail = 0;
+
+/* Bytes of the intent at the head already compared (and written if needed) */
+static BOARD_LOCAL u8 done = 0;
+
+ISR(EE_READY_vect)
+{
+    for (u8 scanned = 0; scanned < EepromWriter::MAX_SCAN; ++scanned) {
+        const auto& intent = queue[queueHead];
+        if (done == intent.size) {
+            done = 0;
+            queueHead = next(queueHead);
+            if (queueHead == queueTail) {
+                pause();
+                return;
+            }
+            continue;
+        }
+
+        const u16 addr = u16(intent.addr + done);
+        const u8 value = intent.src[done];
+        ++done;
+
+        if (eeprom_read_byte(reinterpret_cast<const u8*>(addr)) != value) {
+            EEAR = addr;
+            EEDR = value;
+            EECR |= _BV(EEMPE);
+            EECR |= _BV(EEPE);
+            return;
+        }
+    }
+}
+
+void EepromWriter::write(const u16 addr, const void* src, const u8 size)
+{
+    const Intent intent = { addr, static_cast<const u8*>(src), size };
+
+    pause();
+
+    /* An intent that hasn't started yet will store the newest data already */
+    if (queueHead != queueTail) {
+        for (u8 i = next(queueHead); i != queueTail; i = next(i)) {
+            if (queue[i].addr == intent.addr && queue[i].src == intent.src
+                && queue[i].size == intent.size) {
+                resume();
+                return;
+            }
+        }
+    }
+
+    /* Full: let the interrupt free a slot */
+    if (next(queueTail) == queueHead) {
+        resume();
+        while (next(queueTail) == queueHead)
+            ;
+        pause();
+    }
+
+    queue[queueTail] = intent;
+    queueTail = next(queueTail);
+    resume();
+}
+
+void EepromWriter::read(const u16 addr, void* dst, const size_t size)
+{
+    pause();
+    eeprom_read_block(dst, reinterpret_cast<const void*>(addr), size);
+
+    /* Later intents overwrite the same bytes as earlier ones */
+    const u16 end = u16(addr + size);
+    for (u8 i = queueHead; i != queueTail; i = next(i)) {
+        const auto& intent = queue[i];
+        const u16 overlapBegin = max(addr, intent.addr);
+        const u16 overlapEnd = min(end, u16(intent.addr + intent.size));
+
+        if (overlapBegin < overlapEnd) {
+            memcpy(static_cast<u8*>(dst) + (overlapBegin - addr),
+                intent.src + (overlapBegin - intent.addr), overlapEnd - overlapBegin);
+        }
+    }
+
+    resume();
+}
+
+bool EepromWriter::isPending(const void* src)
+{
+    pause();
+
+    bool pending = false;
+    for (u8 i = queueHead; i != queueTail && !pending; i = next(i))
+        pending = queue[i].src == src;
+
+    resume();
+    return pending;
+}
+
+void EepromWriter::drain()
+{
+    while (queueHead != queueTail)
+        ;
+    eeprom_busy_wait();
+}
+
+void pause() { EECR &= u8(~_BV(EERIE)); }
+
+void resume()
+{
+    if (queueHead != queueTail)
+        EECR |= _BV(EERIE);
+}
+
+u8 next(const u8 i) { return u8((i + 1) % EepromWriter::QUEUE_SIZE); }
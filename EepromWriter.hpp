@@ -0,0 +1,29 @@
+#pragma once
+#include "utils.hpp"
+
+/*
+ *  EEPROM writes in the background, one byte per EE_READY interrupt, so that the loop never
+ *  waits the ~3.3 ms each of them takes. `write` queues the intent to copy `size` bytes of RAM
+ *  from `src` to `addr`; only the bytes that differ are written, in address order.
+ *
+ *  The bytes are read from `src` as they are written, so it must stay valid until
+ *  `isPending(src)` is false. Changing it meanwhile stores the newer data, but may leave a mix
+ *  of old and new bytes until it is written again.
+ *
+ *  `read` sees the pending data as if it were written already. `drain` waits for every write
+ *  to end, before anything that could cut one short (sleep, reset).
+ *
+ *  This owns EE_READY_vect, so the EEPROM library must not be used to write alongside it.
+ */
+struct EepromWriter {
+public:
+    static void write(u16 addr, const void* src, u8 size);
+    static void read(u16 addr, void* dst, size_t size);
+    static bool isPending(const void* src);
+    static void drain();
+
+    static constexpr u8 QUEUE_SIZE = 8;
+
+    /* Unchanged bytes skipped at most by one interrupt, to let the others in */
+    static constexpr u8 MAX_SCAN = 16;
+};
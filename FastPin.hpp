@@ -0,0 +1,31 @@
+#pragma once
+#include "utils.hpp"
+
+/*
+ *  Digital pin access resolved at compile time for the ATmega328P (Arduino Uno numbering):
+ *  every call is a single `sbi`/`cbi` instead of `digitalWrite`'s table lookups. Safe to use
+ *  from interrupts.
+ */
+template <u8 PIN> struct FastPin {
+    static_assert(PIN < 20, "Not an Arduino Uno pin");
+
+    static void high() { port() |= MASK; }
+    static void low() { port() &= u8(~MASK); }
+    static void write(const bool value)
+    {
+        if (value)
+            high();
+        else
+            low();
+    }
+    static void output() { ddr() |= MASK; }
+
+    /* Writing whole ports is up to the caller, who must know no interrupt writes to them */
+    static volatile u8& port() { return PIN < 8 ? PORTD : (PIN < 14 ? PORTB : PORTC); }
+    static volatile u8& ddr() { return PIN < 8 ? DDRD : (PIN < 14 ? DDRB : DDRC); }
+
+    /* 0, 1, 2 for ports D, B, C: pins with the same index share their port */
+    static constexpr u8 PORT_IDX = PIN < 8 ? 0 : (PIN < 14 ? 1 : 2);
+    static constexpr u8 BIT = PIN < 8 ? PIN : (PIN < 14 ? PIN - 8 : PIN - 14);
+    static constexpr u8 MASK = u8(1 << BIT);
+};
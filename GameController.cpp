@@ -1,9 +1,18 @@
 #include "GameController.hpp"
+#include "Animations.hpp"
+#include "Buzzer.hpp"
+#include "EepromWriter.hpp"
+#include "GameRules.hpp"
+#include "Log.hpp"
+#include "MatrixGrayscale.hpp"
 #include "MelodyPlayer.hpp"
+#include "Power.hpp"
+#include <stddef.h>
 
 /* Typedefs */
 using State = GameController::State;
 using Position = GameController::Position;
+using Checkpoint = GameController::Checkpoint;
 
 /* Structs */
 struct StorageEntry {
@@ -11,9 +20,68 @@ struct StorageEntry {
     const void* defaultAddr;
     u16 size;
 };
-struct SpecialChar {
-    u8 data[8];
-    char id;
+using StorageData = Tiny::Array<StorageEntry, 5>;
+enum class Setting : u8 {
+    /* Indices in `storageData` */
+    Contrast = 0,
+    Brightness,
+    Intensity,
+    Sound,
+};
+enum MenuId : u8 {
+    MainMenu = 0,
+    SettingsMenu,
+    AboutMenu,
+    LeaderboardMenu,
+    StatsMenu,
+    DiagnosticsMenu,
+    LatencyMenu,
+    NumMenus,
+    NoMenu = NumMenus,
+};
+enum class MenuAction : u8 {
+    Submenu = 0,
+    State,
+    Slider,
+    Text,
+};
+struct MenuEntry {
+    char label[GameController::NUM_COLS + 1];
+    MenuAction action;
+    union {
+        u8 menu;
+        UpdateFunc state;
+        u8 slider;
+        u8 text;
+    } target;
+};
+struct Menu {
+    char title[GameController::NUM_COLS + 1];
+    const MenuEntry* entries;
+    u8 numEntries;
+    u8 parent;
+    void (*onEnter)(GameController&);
+    /* Menus without entries (lists) print their rows themselves */
+    void (*printRow)(GameController&, i8);
+};
+struct SliderEntry {
+    char description[GameController::NUM_COLS + 1];
+    Setting setting;
+    i32 min, max;
+    i32 step;
+    char icon;
+    void (*callback)(GameController&, i32);
+};
+struct TextEntry {
+    char header[GameController::NUM_COLS - 1];
+    char content[2 * GameController::NUM_COLS + 1];
+};
+struct Label {
+    char text[GameController::NUM_COLS + 1];
+};
+struct StateName {
+    UpdateFunc state;
+    char name[GameController::NUM_COLS + 1];
 };
 
 /* Static constexpr class variables */
@@ -23,207 +91,467 @@ constexpr i32 GameController::DEFAULT_MATRIX_INTENSITY;
 constexpr GameController::LeaderboardEntry GameController::DEFAULT_LEADERBOARD[];
 
 /* Template function declarations */
-template <typename... Ts> static void printfLCD(u8, const char*, Ts&&...);
-template <bool INIT_EEPROM = false> static void setDefaultState(const Input&);
+template <typename... Ts> static void printfLCD(GameController&, u8, const char*, Ts&&...);
+template <bool INIT_EEPROM = false> static void setDefaultState(GameController&, const Input&);
+template <typename Rules> static void gameUpdate(GameController&, const Input&);
 
 /* Function declarations */
-static void readEEPROM(size_t, void*, size_t);
-static void writeEEPROM(size_t, const void*, size_t);
-static void refreshContrast(i32);
-static void refreshBrightness(i32);
-static void refreshIntensity(i32 value);
-static void greetUpdate(const Input&);
-static void gameOverUpdate(const Input&);
-static void mainMenuUpdate(const Input&);
-static void gameUpdate(const Input&);
-static void settingsUpdate(const Input&);
-static void aboutUpdate(const Input&);
-static void sliderUpdate(const Input&);
-static void nameSelectionUpdate(const Input&);
-static void leaderboardUpdate(const Input&);
-static void saveToStorage();
-static void highlightMovement(JoystickController::Direction);
-static void highlightPress(JoystickController::Press);
-
-/* Extern variables */
-GameController gameController;
+static GameController::LcdController makeLcdController();
+static StorageData storageData(GameController&);
+static void refreshContrast(GameController&, i32);
+static void refreshBrightness(GameController&, i32);
+static void refreshIntensity(GameController&, i32 value);
+static void greetUpdate(GameController&, const Input&);
+static void gameOverUpdate(GameController&, const Input&);
+static void startGame(GameController&, const Input&);
+static void menuUpdate(GameController&, const Input&);
+static State menuState(u8 menu, i8 pos, u32 beginTs);
+static void printMenuRow(GameController&, const Menu&, i8);
+static void printLeaderboardRow(GameController&, i8);
+static void printStatsRow(GameController&, i8);
+static void printDiagnosticsRow(GameController&, i8);
+static void printLatencyRow(GameController&, i8);
+static void printStateRow(GameController&, UpdateFunc, u16 value);
+static void textUpdate(GameController&, const Input&);
+static void sliderUpdate(GameController&, const Input&);
+static void printSliderValue(GameController&, const SliderEntry&, i32);
+static void nameSelectionUpdate(GameController&, const Input&);
+static void saveToStorage(GameController&);
+static void highlightMovement(GameController&, JoystickController::Direction);
+static void highlightPress(GameController&, JoystickController::Press);
+static void markDisplayWrite(GameController&);
+static void accountTraffic(GameController&, UpdateFunc, u16 lcdBytes, u16 matrixBytes, u32);
+static bool prepareLevelOrder(GameController&, u32 seed, u8 level, u8 numTiles, u8 maxDraws);
+static void useLevelOrder(GameController&, u32 seed, u8 level, u8 numTiles);
+static Position levelTile(const GameController&, u8 idx);
+static void showLevelTile(GameController&, u8 idx, u8 numTiles);
+static bool playMove(GameController&, const Input&, u8 numTiles);
+static void saveCheckpoint(GameController&);
+static bool loadCheckpoint(GameController&, Checkpoint&);
+static void clearCheckpoint(GameController&);
+static void resumeUpdate(GameController&, const Input&);
 
 /* Constexpr variables */
 static constexpr u8 MAT_SIZE = GameController::MATRIX_SIZE;
-static constexpr u16 GREET_MELODY_DURATION = 10000;
 static constexpr u8 INPUT_SOUND_DUR = 50;
 static constexpr const char* STR_FMT = "%-16s";
 static constexpr const char* INT_FMT = "%-16d";
-static constexpr u8 PRINTF_BUFSIZE = 17;
-static constexpr StorageEntry STORAGE_DATA[] = {
-    {
-        &gameController.lcd.contrast,
-        &GameController::DEFAULT_CONTRAST,
-        sizeof(gameController.lcd.contrast),
-    },
-    {
-        &gameController.lcd.brightness,
-        &GameController::DEFAULT_BRIGHTNESS,
-        sizeof(gameController.lcd.brightness),
-    },
-    {
-        &gameController.matrix.intensity,
-        &GameController::DEFAULT_MATRIX_INTENSITY,
-        sizeof(gameController.matrix.intensity),
-    },
-    {
-        &soundIsEnabled,
-        &SOUND_IS_ENABLED_DEFAULT,
-        sizeof(soundIsEnabled),
-    },
-    {
-        &gameController.leaderboard,
-        &GameController::DEFAULT_LEADERBOARD,
-        sizeof(gameController.leaderboard),
-    },
-};
+static constexpr u16 SETTINGS_SIZE = 4 * sizeof(i32) + sizeof(GameController::leaderboard);
+static constexpr u16 CHECKPOINT_ADDR = 96;
+static constexpr u8 LEVEL_ORDER_SLICE = 8;
 static constexpr State DEFAULT_MENU_STATE = {
-    &mainMenuUpdate,
+    &menuUpdate,
     0,
     true,
-    { .mainMenu = { 0 } },
+    { .menu = { MainMenu, 0 } },
 };
 
-/* Special characters */
+/* Sound effects, by increasing priority */
+static constexpr Buzzer::Note MOVE_NOTES[] PROGMEM = {
+    Buzzer::note(NOTE_FS3, INPUT_SOUND_DUR),
+};
+static constexpr Buzzer::Note PRESS_NOTES[] PROGMEM = {
+    Buzzer::note(NOTE_FS7, INPUT_SOUND_DUR),
+};
+static constexpr Buzzer::Note LEVEL_UP_NOTES[] PROGMEM = {
+    Buzzer::note(NOTE_C6, 60),
+    Buzzer::note(NOTE_E6, 60),
+    Buzzer::note(NOTE_G6, 120),
+};
+static constexpr Buzzer::Note GAME_OVER_NOTES[] PROGMEM = {
+    Buzzer::note(NOTE_G4, 150),
+    Buzzer::note(NOTE_E4, 150),
+    Buzzer::note(NOTE_C4, 300),
+};
+static constexpr Buzzer::Effect MOVE_SOUND = { MOVE_NOTES, u8(Tiny::size(MOVE_NOTES)), 0 };
+static constexpr Buzzer::Effect PRESS_SOUND = { PRESS_NOTES, u8(Tiny::size(PRESS_NOTES)), 1 };
+static constexpr Buzzer::Effect LEVEL_UP_SOUND
+    = { LEVEL_UP_NOTES, u8(Tiny::size(LEVEL_UP_NOTES)), 2 };
+static constexpr Buzzer::Effect GAME_OVER_SOUND
+    = { GAME_OVER_NOTES, u8(Tiny::size(GAME_OVER_NOTES)), 3 };
+
+/* EEPROM layout: settings, then the game checkpoint, then the statistics log */
+static_assert(SETTINGS_SIZE <= CHECKPOINT_ADDR,
+    "The settings overlap the checkpoint");
+static_assert(CHECKPOINT_ADDR + GameController::NUM_CHECKPOINT_SLOTS * sizeof(Checkpoint)
+        <= StatsLog::BEGIN,
+    "The checkpoint overlaps the statistics log");
+static_assert(ActiveRules::MAX_TILES <= GameController::MAX_LEVEL_AMOUNT,
+    "A level can't show more tiles than the matrix has");
+
+/*
+ *  Custom glyphs, uploaded to the LCD on demand by `lcd.glyphs`. Their ids are control
+ *  characters, so strings embed them directly (e.g. through the `_STR` macros).
+ */
+enum Glyph : char {
+    UpDownArrow = 1,
+    DownArrow,
+    /* A cell with its first 1 to 4 pixel columns filled, `FULL_BLOCK` has all 5 */
+    Bar1,
+    Bar2,
+    Bar3,
+    Bar4,
+    Speaker,
+    Sun,
+    HalfCircle,
+    Grid,
+    NumGlyphs,
+};
 #define UP_DOWN_ARROW_STR "\1"
 #define DOWN_ARROW_STR "\2"
-#define UP_DOWN_ARROW '\1'
-#define DOWN_ARROW '\2'
-static SpecialChar SPECIAL_CHARS[] = {
-    {
-        {
-            0b00100,
-            0b01010,
-            0b10001,
-            0b00000,
-            0b00000,
-            0b10001,
-            0b01010,
-            0b00100,
-        },
-        UP_DOWN_ARROW,
+static_assert(UP_DOWN_ARROW_STR[0] == UpDownArrow && DOWN_ARROW_STR[0] == DownArrow,
+    "The string forms of the glyphs are out of sync");
+static_assert(GlyphCache::isGlyph(NumGlyphs - 1), "Glyph ids must be control characters");
+
+/* Character of the HD44780 ROM */
+static constexpr char FULL_BLOCK = char(0xFF);
+static constexpr u8 BAR_CELLS = 10;
+static constexpr u8 BAR_CELL_WIDTH = 5;
+
+static constexpr GlyphCache::Bitmap GLYPHS[] PROGMEM = {
+    [UpDownArrow - 1] = { {
+        0b00100,
+        0b01010,
+        0b10001,
+        0b00000,
+        0b00000,
+        0b10001,
+        0b01010,
+        0b00100,
+    } },
+    [DownArrow - 1] = { {
+        0b00000,
+        0b00000,
+        0b00000,
+        0b00000,
+        0b00000,
+        0b10001,
+        0b01010,
+        0b00100,
+    } },
+    [Bar1 - 1] = { { 0, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0 } },
+    [Bar2 - 1] = { { 0, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0 } },
+    [Bar3 - 1] = { { 0, 0b11100, 0b11100, 0b11100, 0b11100, 0b11100, 0b11100, 0 } },
+    [Bar4 - 1] = { { 0, 0b11110, 0b11110, 0b11110, 0b11110, 0b11110, 0b11110, 0 } },
+    [Speaker - 1] = { {
+        0b00001,
+        0b00011,
+        0b11111,
+        0b11111,
+        0b11111,
+        0b00011,
+        0b00001,
+        0b00000,
+    } },
+    [Sun - 1] = { {
+        0b00000,
+        0b10101,
+        0b01110,
+        0b11011,
+        0b01110,
+        0b10101,
+        0b00000,
+        0b00000,
+    } },
+    [HalfCircle - 1] = { {
+        0b01110,
+        0b10011,
+        0b10111,
+        0b10111,
+        0b10111,
+        0b10011,
+        0b01110,
+        0b00000,
+    } },
+    [Grid - 1] = { {
+        0b10101,
+        0b00000,
+        0b10101,
+        0b00000,
+        0b10101,
+        0b00000,
+        0b10101,
+        0b00000,
+    } },
+};
+
+/*
+ *  Menus, kept in program memory. Every menu is drawn and navigated by `menuUpdate`: up/down
+ *  move through the entries, right enters the selected one and left goes back to the parent.
+ */
+enum SliderId : u8 {
+    ContrastSlider = 0,
+    BrightnessSlider,
+    IntensitySlider,
+    SoundSlider,
+};
+static constexpr SliderEntry SLIDERS[] PROGMEM = {
+    [ContrastSlider]
+    = { "< CONTRAST", Setting::Contrast, 0, 255, 10, HalfCircle, &refreshContrast },
+    [BrightnessSlider]
+    = { "< BRIGHTNESS", Setting::Brightness, 0, 255, 20, Sun, &refreshBrightness },
+    [IntensitySlider]
+    = { "< INTENSITY", Setting::Intensity, 0, 15, 1, Grid, &refreshIntensity },
+    [SoundSlider] = { "< SOUND", Setting::Sound, 0, 1, 1, Speaker, nullptr },
+};
+
+enum TextId : u8 {
+    GameNameText = 0,
+    AuthorText,
+    GitLinkText,
+};
+static constexpr TextEntry TEXTS[] PROGMEM = {
+    [GameNameText] = { "Game Name", "Remember" },
+    [AuthorText] = { "Author", "Nicula Ionut 334" },
+    [GitLinkText] = { "Git Link", "github.com/niculaionut/remember" },
+};
+
+static constexpr Label STATS_LABELS[] PROGMEM = {
+    { "Games" },
+    { "Best level" },
+    { "Avg level" },
+    { "Avg reviews" },
+    { "Sec/level" },
+};
+
+static constexpr MenuEntry MAIN_MENU_ENTRIES[] PROGMEM = {
+    { DOWN_ARROW_STR " Start Game", MenuAction::State, { .state = &startGame } },
+    { UP_DOWN_ARROW_STR " Leaderboard", MenuAction::Submenu, { .menu = LeaderboardMenu } },
+    { UP_DOWN_ARROW_STR " Statistics", MenuAction::Submenu, { .menu = StatsMenu } },
+    { UP_DOWN_ARROW_STR " Settings", MenuAction::Submenu, { .menu = SettingsMenu } },
+    { "^ About", MenuAction::Submenu, { .menu = AboutMenu } },
+};
+static constexpr MenuEntry SETTINGS_MENU_ENTRIES[] PROGMEM = {
+    { DOWN_ARROW_STR " Contrast", MenuAction::Slider, { .slider = ContrastSlider } },
+    { UP_DOWN_ARROW_STR " Brightness", MenuAction::Slider, { .slider = BrightnessSlider } },
+    { UP_DOWN_ARROW_STR " Intensity", MenuAction::Slider, { .slider = IntensitySlider } },
+    { UP_DOWN_ARROW_STR " Sound", MenuAction::Slider, { .slider = SoundSlider } },
+    { "^ Default state", MenuAction::State, { .state = &setDefaultState } },
+};
+static constexpr MenuEntry ABOUT_MENU_ENTRIES[] PROGMEM = {
+    { DOWN_ARROW_STR " Game Name", MenuAction::Text, { .text = GameNameText } },
+    { UP_DOWN_ARROW_STR " Author", MenuAction::Text, { .text = AuthorText } },
+    { UP_DOWN_ARROW_STR " Github Link", MenuAction::Text, { .text = GitLinkText } },
+    { UP_DOWN_ARROW_STR " Diagnostics", MenuAction::Submenu, { .menu = DiagnosticsMenu } },
+    { "^ Latency", MenuAction::Submenu, { .menu = LatencyMenu } },
+};
+
+/* Names of the states on the diagnostics screens */
+static constexpr StateName STATE_NAMES[] PROGMEM = {
+    { &greetUpdate, "Greet" },
+    { &menuUpdate, "Menu" },
+    { &textUpdate, "Text" },
+    { &sliderUpdate, "Slider" },
+    { &resumeUpdate, "Resume" },
+    { &startGame, "Start game" },
+    { &gameUpdate<ActiveRules>, "Game" },
+    { &gameOverUpdate, "Game over" },
+    { &nameSelectionUpdate, "Name" },
+    { &setDefaultState<>, "Default state" },
+};
+static_assert(Tiny::size(STATE_NAMES) == GameController::NUM_STATES,
+    "Every state function has a name, and a latency and a stack slot");
+
+static constexpr Menu MENUS[NumMenus] PROGMEM = {
+    [MainMenu] = {
+        "> MAIN MENU",
+        MAIN_MENU_ENTRIES,
+        u8(Tiny::size(MAIN_MENU_ENTRIES)),
+        NoMenu,
+        nullptr,
+        nullptr,
     },
-    {
-        {
-            0b00000,
-            0b00000,
-            0b00000,
-            0b00000,
-            0b00000,
-            0b10001,
-            0b01010,
-            0b00100,
-        },
-        DOWN_ARROW,
+    [SettingsMenu] = {
+        "<> SETTINGS",
+        SETTINGS_MENU_ENTRIES,
+        u8(Tiny::size(SETTINGS_MENU_ENTRIES)),
+        MainMenu,
+        &saveToStorage,
+        nullptr,
+    },
+    [AboutMenu] = {
+        "<> ABOUT",
+        ABOUT_MENU_ENTRIES,
+        u8(Tiny::size(ABOUT_MENU_ENTRIES)),
+        MainMenu,
+        nullptr,
+        nullptr,
+    },
+    [LeaderboardMenu] = {
+        UP_DOWN_ARROW_STR "LEADERBOARD <",
+        nullptr,
+        GameController::LEADERBOARD_SIZE,
+        MainMenu,
+        nullptr,
+        &printLeaderboardRow,
+    },
+    [StatsMenu] = {
+        UP_DOWN_ARROW_STR "STATISTICS <",
+        nullptr,
+        u8(Tiny::size(STATS_LABELS)),
+        MainMenu,
+        nullptr,
+        &printStatsRow,
+    },
+    [DiagnosticsMenu] = {
+        UP_DOWN_ARROW_STR "FREE RAM <",
+        nullptr,
+        u8(1 + Tiny::size(STATE_NAMES)),
+        AboutMenu,
+        nullptr,
+        &printDiagnosticsRow,
+    },
+    [LatencyMenu] = {
+        UP_DOWN_ARROW_STR "LATENCY P95 <",
+        nullptr,
+        GameController::NUM_LATENCY_SLOTS,
+        AboutMenu,
+        nullptr,
+        &printLatencyRow,
     },
 };
 
-/* Static variables */
-static char printfBuffer[PRINTF_BUFSIZE] = {};
-static GameController::LeaderboardEntry currentPlayer = { "         ", 0 };
-static Tiny::Array<Position, MAT_SIZE * MAT_SIZE> matrixOrder = {};
-static MelodyPlayer mp(CONTRAPUNCTUS_1, GREET_MELODY_DURATION);
 
-template <typename... Ts> static void printfLCD(u8 row, const char* fmt, Ts&&... args)
+template <typename... Ts>
+static void printfLCD(GameController& gc, u8 row, const char* fmt, Ts&&... args)
 {
-    snprintf(&printfBuffer[0], PRINTF_BUFSIZE, fmt, args...);
+    static constexpr i16 MAX_LEN = GameController::PRINTF_BUFSIZE - 1;
+    const i16 written = i16(snprintf(&gc.printfBuffer[0], MAX_LEN + 1, fmt, args...));
+    const i16 len = written < MAX_LEN ? written : MAX_LEN;
+
+    /*
+     *  Glyph ids become the slots that hold them. This goes before `setCursor`, as uploading a
+     *  glyph leaves the LCD addressing CGRAM. Slot 0 is a NUL, hence `write` with a length.
+     */
+    gc.lcd.glyphs.beginRow(row);
+    for (i16 i = 0; i < len; ++i) {
+        auto& c = gc.printfBuffer[i];
+        if (GlyphCache::isGlyph(c))
+            c = gc.lcd.glyphs.get(gc.lcd.controller, c, row);
+    }
 
-    gameController.lcd.controller.setCursor(0, row);
-    gameController.lcd.controller.print(&printfBuffer[0]);
+    gc.lcd.controller.setCursor(0, row);
+    gc.lcd.controller.write(&gc.printfBuffer[0], size_t(len));
+    markDisplayWrite(gc);
 }
 
-template <bool INIT_EEPROM> void setDefaultState(const Input&)
+template <bool INIT_EEPROM> void setDefaultState(GameController& gc, const Input&)
 {
     size_t eepromAddr = 0;
-    for (auto& data : STORAGE_DATA) {
+    for (auto& data : storageData(gc)) {
         if constexpr (INIT_EEPROM) {
-            writeEEPROM(eepromAddr, data.defaultAddr, data.size);
+            EepromWriter::write(eepromAddr, data.defaultAddr, u8(data.size));
             eepromAddr += data.size;
         }
 
         memcpy(data.addr, data.defaultAddr, data.size);
     }
 
-    refreshContrast(gameController.lcd.contrast);
-    refreshBrightness(gameController.lcd.brightness);
-    refreshIntensity(gameController.matrix.intensity);
+    refreshContrast(gc, gc.lcd.contrast);
+    refreshBrightness(gc, gc.lcd.brightness);
+    refreshIntensity(gc, gc.matrix.intensity);
 
-    gameController.state = { &settingsUpdate, 0, true, {} };
+    gc.state = menuState(SettingsMenu, 0, 0);
 }
 
-static void readEEPROM(size_t eepromBaseAddr, void* addr, size_t count)
+StorageData storageData(GameController& gc)
 {
-    auto bytes = (u8*)addr;
-    for (size_t i = 0; i < count; ++i)
-        bytes[i] = EEPROM.read(i16(eepromBaseAddr + i));
+    return { {
+        {
+            &gc.lcd.contrast,
+            &GameController::DEFAULT_CONTRAST,
+            sizeof(gc.lcd.contrast),
+        },
+        {
+            &gc.lcd.brightness,
+            &GameController::DEFAULT_BRIGHTNESS,
+            sizeof(gc.lcd.brightness),
+        },
+        {
+            &gc.matrix.intensity,
+            &GameController::DEFAULT_MATRIX_INTENSITY,
+            sizeof(gc.matrix.intensity),
+        },
+        {
+            &gc.soundIsEnabled,
+            &SOUND_IS_ENABLED_DEFAULT,
+            sizeof(gc.soundIsEnabled),
+        },
+        {
+            &gc.leaderboard,
+            &GameController::DEFAULT_LEADERBOARD,
+            sizeof(gc.leaderboard),
+        },
+    } };
 }
 
-static void writeEEPROM(size_t eepromBaseAddr, const void* addr, size_t count)
+void refreshContrast(GameController&, i32 value)
 {
-    auto bytes = (const u8*)addr;
-    for (size_t i = 0; i < count; ++i)
-        EEPROM.update(i16(eepromBaseAddr + i), bytes[i]);
+    analogWrite(GameController::CONTRAST_PIN, i16(value));
 }
 
-void refreshContrast(i32 value) { analogWrite(GameController::CONTRAST_PIN, i16(value)); }
-
-void refreshBrightness(i32 value) { analogWrite(GameController::BRIGHTNESS_PIN, i16(value)); }
+void refreshBrightness(GameController&, i32 value)
+{
+    analogWrite(GameController::BRIGHTNESS_PIN, i16(value));
+}
 
-void refreshIntensity(i32 value)
+void refreshIntensity(GameController& gc, i32 value)
 {
-    gameController.matrix.controller.setIntensity(0, i16(value));
+    gc.matrix.controller.setIntensity(0, i16(value));
 }
 
-void greetUpdate(const Input& input)
+void greetUpdate(GameController& gc, const Input& input)
 {
-    auto& state = gameController.state;
+    auto& state = gc.state;
 
     if (state.entry) {
         state.entry = false;
 
-        printfLCD(0, STR_FMT, "REMEMBER");
-        printfLCD(1, STR_FMT, "A Memory Game");
+        printfLCD(gc, 0, STR_FMT, "REMEMBER");
+        printfLCD(gc, 1, STR_FMT, "A Memory Game");
+
+        gc.matrix.animator.play(ATTRACT, input.currentTs);
     }
 
-    mp.play(input.currentTs);
+    gc.melodyPlayer.play(input.currentTs, gc.soundIsEnabled);
 
     if (u8(input.joyPress)) {
-        mp.stop();
-        highlightPress(input.joyPress);
+        gc.melodyPlayer.stop();
+        gc.matrix.animator.stop();
+        gc.matrix.controller.clearDisplay(0);
+        highlightPress(gc, input.joyPress);
         state = DEFAULT_MENU_STATE;
     }
 }
 
-void gameOverUpdate(const Input& input)
+void gameOverUpdate(GameController& gc, const Input& input)
 {
     static constexpr u32 DURATION = 5000;
 
-    auto& state = gameController.state;
-    auto& params = gameController.state.params.gameOver;
+    auto& state = gc.state;
+    auto& params = gc.state.params.gameOver;
 
     if (state.entry) {
         state.entry = false;
 
-        currentPlayer.score = i8(params.score);
+        gc.currentPlayer.score = i8(params.score);
         params.rank = 0;
         while (params.rank < GameController::LEADERBOARD_SIZE
-            && params.score <= gameController.leaderboard[params.rank].score)
+            && params.score <= gc.leaderboard[params.rank].score)
             ++params.rank;
 
         if (params.rank < GameController::LEADERBOARD_SIZE)
             params.highScore = true;
 
-        printfLCD(0, STR_FMT, "GAME OVER!");
-        printfLCD(1, "%s %-2d %s %2d", "Score", params.score, "Rank", params.rank + 1);
+        printfLCD(gc, 0, STR_FMT, "GAME OVER!");
+        printfLCD(gc, 1, "%s %-2d %s %2d", "Score", params.score, "Rank", params.rank + 1);
     }
 
     if (u8(input.joyPress) || input.currentTs - state.beginTs > DURATION) {
-        highlightPress(input.joyPress);
+        highlightPress(gc, input.joyPress);
+
+        gc.matrix.animator.stop();
+        gc.matrix.controller.clearDisplay(0);
 
         if (params.highScore) {
             const auto score = params.score;
@@ -242,533 +570,469 @@ void gameOverUpdate(const Input& input)
     }
 }
 
-void mainMenuUpdate(const Input& input)
+void startGame(GameController& gc, const Input& input)
 {
-    enum MenuPosition : u8 {
-        StartGame = 0,
-        Leaderboard,
-        Settings,
-        About,
-        NumPositions,
-    };
-
-    static constexpr const char* MENU_DESCRIPTORS[NumPositions] = {
-        [StartGame] = DOWN_ARROW_STR " Start Game",
-        [Leaderboard] = UP_DOWN_ARROW_STR " Leaderboard",
-        [Settings] = UP_DOWN_ARROW_STR " Settings",
-        [About] = "^ About",
-    };
+    gc.state = GameController::gameState<ActiveRules>(input.currentTs);
+}
 
-    auto& state = gameController.state;
-    auto& params = gameController.state.params.mainMenu;
+void menuUpdate(GameController& gc, const Input& input)
+{
+    auto& state = gc.state;
+    auto& params = gc.state.params.menu;
+    const auto menu = Tiny::readPgm(&MENUS[params.menu]);
 
     if (state.entry) {
         state.entry = false;
 
-        printfLCD(0, STR_FMT, "> MAIN MENU");
-        printfLCD(1, STR_FMT, MENU_DESCRIPTORS[params.pos]);
+        printfLCD(gc, 0, STR_FMT, menu.title);
+        printMenuRow(gc, menu, params.pos);
+
+        if (menu.onEnter != nullptr)
+            menu.onEnter(gc);
     }
 
-    highlightMovement(input.joyDir);
+    highlightMovement(gc, input.joyDir);
 
     const i8 delta = input.joyDir == JoystickController::Direction::Up
         ? -1
         : (input.joyDir == JoystickController::Direction::Down ? 1 : 0);
-    const auto newPos = i8(Tiny::clamp(params.pos + delta, 0, NumPositions - 1));
+    const auto newPos = i8(Tiny::clamp(params.pos + delta, 0, menu.numEntries - 1));
 
     if (newPos != params.pos) {
         params.pos = newPos;
 
-        printfLCD(1, STR_FMT, MENU_DESCRIPTORS[params.pos]);
+        printMenuRow(gc, menu, params.pos);
     }
 
-    if (input.joyDir == JoystickController::Direction::Right) {
-        switch (params.pos) {
-        case StartGame: {
-            state = State {
-                &gameUpdate,
-                0,
-                true,
-                {
-                    .game = {
-                        { 0, 0 },
-                        0,
-                        0,
-                        1,
-                        0,
-                        0,
-                        0,
-                    }
-                },
-            };
-            break;
-        }
-        case Leaderboard: {
-            state = State {
-                &leaderboardUpdate,
-                0,
-                true,
-                {
-                    .leaderboard = {
-                        0,
-                    }
-                },
-            };
+    if (input.joyRepeat)
+        return;
+
+    if (input.joyDir == JoystickController::Direction::Left && menu.parent != NoMenu)
+        state = menuState(menu.parent, 0, input.currentTs);
+
+    if (input.joyDir == JoystickController::Direction::Right && menu.entries != nullptr) {
+        const auto menuId = params.menu;
+        const auto pos = params.pos;
+        const auto entry = Tiny::readPgm(&menu.entries[pos]);
+
+        switch (entry.action) {
+        case MenuAction::Submenu:
+            state = menuState(entry.target.menu, 0, input.currentTs);
             break;
-        }
-        case Settings: {
-            state = State { &settingsUpdate, 0, true, {} };
+        case MenuAction::State:
+            state = { entry.target.state, input.currentTs, true, {} };
             break;
-        }
-        case About: {
-            state = State {
-                &aboutUpdate,
-                0,
-                true,
-                {
-                    .about = {
-                        0,
-                        0,
-                        0,
-                        nullptr,
-                        nullptr,
-                    }
-                },
+        case MenuAction::Slider: {
+            const auto setting = pgm_read_byte(&SLIDERS[entry.target.slider].setting);
+            state = { &sliderUpdate, input.currentTs, true, {} };
+            state.params.slider = {
+                entry.target.slider,
+                static_cast<i32*>(storageData(gc)[setting].addr),
+                menuId,
+                pos,
             };
             break;
         }
+        case MenuAction::Text:
+            state = { &textUpdate, input.currentTs, true, {} };
+            state.params.text = { entry.target.text, 0, menuId, pos, {} };
+            break;
         default:
             UNREACHABLE;
         }
-
-        state.beginTs = input.currentTs;
     }
 }
 
-void gameUpdate(const Input& input)
+State menuState(const u8 menu, const i8 pos, const u32 beginTs)
 {
-    static constexpr u32 DEFAULT_TIME = 500;
-    static constexpr i16 NUM_REVIEWS_LIMIT = 4;
+    return { &menuUpdate, beginTs, true, { .menu = { menu, pos } } };
+}
 
-    enum class State : u8 {
-        GenerateLevel = 0,
-        ShowLevel,
-        Playing,
-    };
+void printMenuRow(GameController& gc, const Menu& menu, const i8 pos)
+{
+    if (menu.printRow != nullptr)
+        menu.printRow(gc, pos);
+    else
+        printfLCD(gc, 1, STR_FMT, Tiny::readPgm(&menu.entries[pos]).label);
+}
 
-    auto& lc = gameController.matrix.controller;
-    auto& state = gameController.state;
-    auto& params = gameController.state.params.game;
+void printLeaderboardRow(GameController& gc, const i8 pos)
+{
+    const auto& entry = gc.leaderboard[pos];
+    printfLCD(gc, 1, "%1d. %-10s %2d", pos + 1, entry.name, entry.score);
+}
 
-    const auto maxReviews
-        = Tiny::clamp(NUM_REVIEWS_LIMIT - params.level / 4, 1, NUM_REVIEWS_LIMIT);
-    if (state.entry) {
-        state.entry = false;
+void printStatsRow(GameController& gc, const i8 pos)
+{
+    enum StatsPosition : i8 {
+        Games = 0,
+        BestLevel,
+        AvgLevel,
+        AvgReviews,
+        SecondsPerLevel,
+    };
 
-        switch (params.subState) {
-        case u8(State::GenerateLevel):
-            printfLCD(0, "%-8s%8s", "Score", "Reviews");
-            printfLCD(1, "%-8d%8d", params.score, maxReviews - params.usedReviews);
+    const auto& totals = gc.stats.totals();
+    const auto ratio = [](const u32 num, const u16 den) { return u16(den ? num / den : 0); };
 
-            randomSeed(micros());
-            Tiny::shuffle(matrixOrder);
+    /* The totals are kept up to date by the log, so nothing is read from the EEPROM here */
+    u16 value = 0;
+    switch (pos) {
+    case Games:
+        value = totals.gamesPlayed;
+        break;
+    case BestLevel:
+        value = totals.bestLevel;
+        break;
+    case AvgLevel:
+        value = ratio(totals.levels, totals.gamesPlayed);
+        break;
+    case AvgReviews:
+        value = ratio(totals.reviews, totals.gamesPlayed);
+        break;
+    case SecondsPerLevel:
+        value = ratio(totals.seconds, totals.levels);
+        break;
+    default:
+        UNREACHABLE;
+    }
 
-            lc.clearDisplay(0);
-            params.subState = u8(State::ShowLevel);
-            params.player = matrixOrder[0];
+    printfLCD(gc, 1, "%-11s%5u", Tiny::readPgm(&STATS_LABELS[pos]).text, value);
+}
 
-            break;
-        case u8(State::ShowLevel):
-            lc.clearDisplay(0);
-            printfLCD(1, "%-8d%8d", params.score, maxReviews - params.usedReviews);
-            break;
-        case u8(State::Playing):
-            lc.setLed(0, params.player.y, params.player.x, true);
-            break;
-        default:
-            UNREACHABLE;
-        }
+/* The free RAM now (that is, since this screen opened), then its low for every state */
+void printDiagnosticsRow(GameController& gc, const i8 pos)
+{
+    if (pos == 0) {
+        printfLCD(gc, 1, "%-11s%5u", "Now", Stack::unused());
+        return;
     }
 
-    switch (params.subState) {
-    case u8(State::ShowLevel): {
-        const auto onTime = DEFAULT_TIME / 2;
-        const u32 intervalNum = (input.currentTs - state.beginTs) / onTime;
-        const auto oddInterval = intervalNum % 2;
-        if (oddInterval && ((intervalNum + 1) / 2) == (params.tileIdx + 1u)) {
-            if (params.tileIdx < min(GameController::MAX_LEVEL_AMOUNT, params.level))
-                lc.setLed(
-                    0, matrixOrder[params.tileIdx].y, matrixOrder[params.tileIdx].x, true);
-
-            ++params.tileIdx;
-        }
+    if (u8(pos - 1) >= gc.stack.slots.size()) {
+        printfLCD(gc, 1, STR_FMT, "-");
+        return;
+    }
 
-        if (params.tileIdx == (min(GameController::MAX_LEVEL_AMOUNT, params.level) + 1)) {
-            state.entry = true;
-            params.subState = u8(State::Playing);
-        }
+    const auto& slot = gc.stack.slots[u8(pos - 1)];
+    printStateRow(gc, slot.key, slot.minFree);
+}
 
-        break;
+/* The 95th percentile of the input-to-photon latency (us) of every state that got input */
+void printLatencyRow(GameController& gc, const i8 pos)
+{
+    const auto& slot = gc.latency.slots[u8(pos)];
+    if (slot.key == UpdateFunc {}) {
+        printfLCD(gc, 1, STR_FMT, "-");
+        return;
     }
-    case u8(State::Playing): {
-        if (!params.captured && params.usedReviews < maxReviews
-            && input.joyPress == JoystickController::Press::Long) {
-            highlightPress(input.joyPress);
-
-            state.entry = true;
-            state.beginTs = input.currentTs;
-            params.player = matrixOrder[0];
-            params.tileIdx = 0;
-            params.subState = u8(State::ShowLevel);
-            ++params.usedReviews;
-            break;
-        }
 
-        highlightMovement(input.joyDir);
+    printStateRow(gc, slot.key, u16(min(slot.histogram.percentile(95), u32(0xFFFF))));
+}
 
-        const auto oldPos = params.player;
-        switch (input.joyDir) {
-        case JoystickController::Direction::Up:
-            ++params.player.y;
-            break;
-        case JoystickController::Direction::Down:
-            --params.player.y;
-            break;
-        case JoystickController::Direction::Left:
-            ++params.player.x;
-            break;
-        case JoystickController::Direction::Right:
-            --params.player.x;
-            break;
-        default:
-            break;
-        }
+/* The name of a state (its address if it has none) and a value */
+void printStateRow(GameController& gc, const UpdateFunc state, const u16 value)
+{
+    char name[GameController::NUM_COLS + 1];
+    if (GameController::stateName(state, name))
+        printfLCD(gc, 1, "%-11s%5u", name, value);
+    else
+        printfLCD(gc, 1, "%04x%12u", u16(reinterpret_cast<uintptr_t>(state)), value);
+}
 
-        params.player = params.player.clamp(0, GameController::MATRIX_SIZE - 1);
+void textUpdate(GameController& gc, const Input& input)
+{
+    auto& state = gc.state;
+    auto& params = gc.state.params.text;
+    const auto text = Tiny::readPgm(&TEXTS[params.text]);
+    state.entry = false;
 
-        if (oldPos != params.player) {
-            const auto oldPosOrderIdx = Tiny::find(
-                matrixOrder, oldPos, [](Position p1, Position p2) { return p1 == p2; });
+    CO_BEGIN(params.co);
 
-            if (oldPosOrderIdx >= min(GameController::MAX_LEVEL_AMOUNT, params.level)
-                || oldPosOrderIdx < params.captured)
-                lc.setLed(0, oldPos.y, oldPos.x, false);
+    printfLCD(gc, 0, "< %-14s", text.header);
+    printfLCD(gc, 1, STR_FMT, text.content);
 
-            lc.setLed(0, params.player.y, params.player.x, true);
-        }
+    for (;;) {
+        CO_AWAIT_INPUT(params.co, input);
 
-        if (input.joyPress == JoystickController::Press::Short) {
-            highlightPress(input.joyPress);
-
-            if (params.player == matrixOrder[params.captured]) {
-                ++params.captured;
-            } else {
-                const auto score = params.score;
-                lc.clearDisplay(0);
-                state = { &gameOverUpdate, input.currentTs, true, {} };
-                state.params.gameOver.score = score;
-                break;
-            }
+        highlightMovement(gc, input.joyDir);
 
-            if (params.captured == min(GameController::MAX_LEVEL_AMOUNT, params.level)) {
-                state.entry = true;
-                state.beginTs = input.currentTs;
-                params = {
-                    {},
-                    0,
-                    u8(State::GenerateLevel),
-                    u8(params.level + 1),
-                    0,
-                    u8(params.score + 1),
-                    0,
-                };
-            }
-        }
+        const auto oldShift = params.shift;
+        const i16 delta = input.joyDir == JoystickController::Direction::Up
+            ? -5
+            : (input.joyDir == JoystickController::Direction::Down ? 5 : 0);
+        params.shift
+            = Tiny::clamp(i16(params.shift + delta), i16(0), i16(strlen(text.content) - 1));
 
-        break;
-    }
-    default:
-        break;
+        if (params.shift != oldShift)
+            printfLCD(gc, 1, STR_FMT, text.content + params.shift);
+
+        if (input.joyDir == JoystickController::Direction::Left && !input.joyRepeat) {
+            state = menuState(params.menu, params.pos, input.currentTs);
+            return;
+        }
     }
+
+    CO_END;
 }
 
-void settingsUpdate(const Input& input)
+template <typename Rules> void gameUpdate(GameController& gc, const Input& input)
 {
-    enum SettingsPosition : u8 {
-        Contrast = 0,
-        Brightness,
-        Intensity,
-        Sound,
-        DefaultState,
-        NumPositions,
-    };
-
-    static constexpr const char* SETTINGS_DESCRIPTORS[NumPositions] = {
-        [Contrast] = DOWN_ARROW_STR " Contrast",
-        [Brightness] = UP_DOWN_ARROW_STR " Brightness",
-        [Intensity] = UP_DOWN_ARROW_STR " Intensity",
-        [Sound] = UP_DOWN_ARROW_STR " Sound",
-        [DefaultState] = "^ Default state",
-    };
+    auto& lc = gc.matrix.controller;
+    auto& state = gc.state;
+    auto& params = gc.state.params.game;
+    auto& co = params.co;
+
+    const auto maxReviews = GameRules::maxReviews<Rules>(params.level);
+    const auto numTiles = GameRules::numTiles<Rules>(params.level);
+    state.entry = false;
+
+    CO_BEGIN(co);
+
+    printfLCD(gc, 0, "%-8s%8s", "Score", "Reviews");
+    lc.clearDisplay(0);
+
+    for (;;) {
+        /*
+         *  Between levels, the LCD still shows the header, the matrix is drawn over by the
+         *  transition animation and the order was mostly drawn in the background.
+         */
+        printfLCD(gc, 1, "%-8d%8d", params.score, maxReviews - params.usedReviews);
+        Log::write<LogId::LevelStart>(params.level, params.score);
+
+        useLevelOrder(gc, params.seed, params.level, numTiles);
+        saveCheckpoint(gc);
+        params.player = levelTile(gc, 0);
+        markDisplayWrite(gc);
+
+        /* Show the order, then play until a review (which shows it again) or the end */
+        do {
+            /* The level starts showing once the transition animation is over */
+            CO_AWAIT(co, !gc.matrix.animator.isPlaying());
+
+            CO_AWAIT_MS(co, input.currentTs, Rules::SHOW_TIME / 2);
+            for (params.tileIdx = 0; params.tileIdx < numTiles; ++params.tileIdx) {
+                showLevelTile(gc, params.tileIdx, numTiles);
+                CO_AWAIT_MS(co, input.currentTs, Rules::SHOW_TIME);
+            }
 
-    auto& state = gameController.state;
-    auto& params = gameController.state.params.settings;
+            if (MatrixGrayscale::isActive()) {
+                MatrixGrayscale::end(lc);
+                Log::write<LogId::GrayscaleLoad>(MatrixGrayscale::cpuLoadPermille());
+            }
+            lc.setLed(0, params.player.y, params.player.x, true);
+            markDisplayWrite(gc);
+
+            for (;;) {
+                CO_YIELD(co);
+
+                /* Frames without input draw a slice of the next level's order */
+                if (!u8(input.joyDir) && !u8(input.joyPress)) {
+                    const auto next = u8(params.level + 1);
+                    prepareLevelOrder(gc, params.seed, next, GameRules::numTiles<Rules>(next),
+                        LEVEL_ORDER_SLICE);
+                    continue;
+                }
+
+                if (!params.captured && params.usedReviews < maxReviews
+                    && input.joyPress == JoystickController::Press::Long) {
+                    highlightPress(gc, input.joyPress);
+
+                    params.player = levelTile(gc, 0);
+                    ++params.usedReviews;
+                    ++params.totalReviews;
+
+                    lc.clearDisplay(0);
+
+                    /* Reviews show the order as a gradient as well, brightest first */
+                    MatrixGrayscale::begin();
+                    printfLCD(gc, 1, "%-8d%8d", params.score, maxReviews - params.usedReviews);
+                    markDisplayWrite(gc);
+                    break;
+                }
+
+                if (!playMove(gc, input, numTiles)) {
+                    const auto score = params.score;
+                    Log::write<LogId::GameOver>(score);
+                    gc.stats.append(params.level, params.totalReviews,
+                        u16((input.currentTs - params.gameBeginTs) / 1000));
+                    clearCheckpoint(gc);
+
+                    if (gc.soundIsEnabled)
+                        Buzzer::play(GAME_OVER_SOUND);
+                    lc.clearDisplay(0);
+                    gc.matrix.animator.play(GAME_OVER, input.currentTs);
+                    markDisplayWrite(gc);
+                    state = { &gameOverUpdate, input.currentTs, true, {} };
+                    state.params.gameOver.score = score;
+                    return;
+                }
+
+                if (params.captured == numTiles)
+                    break;
+            }
+        } while (params.captured < numTiles);
 
-    if (state.entry) {
-        state.entry = false;
+        if (gc.soundIsEnabled)
+            Buzzer::play(LEVEL_UP_SOUND);
+        gc.matrix.animator.play(LEVEL_COMPLETE, input.currentTs);
 
-        printfLCD(0, STR_FMT, "<> SETTINGS");
-        printfLCD(1, STR_FMT, SETTINGS_DESCRIPTORS[params.pos]);
+        ++params.level;
+        ++params.score;
+        params.captured = 0;
+        params.usedReviews = 0;
 
-        saveToStorage();
+        /* The new level's tile count and reviews are computed on the next frame */
+        CO_YIELD(co);
     }
 
-    highlightMovement(input.joyDir);
-
-    const i8 delta = input.joyDir == JoystickController::Direction::Up
-        ? -1
-        : (input.joyDir == JoystickController::Direction::Down ? 1 : 0);
-    const auto newPos = i8(Tiny::clamp(params.pos + delta, 0, NumPositions - 1));
-
-    if (newPos != params.pos) {
-        params.pos = newPos;
-
-        printfLCD(1, STR_FMT, SETTINGS_DESCRIPTORS[params.pos]);
-    }
+    CO_END;
+}
 
-    if (input.joyDir == JoystickController::Direction::Right) {
-        switch (params.pos) {
-        case Contrast: {
-            state = State {
-                &sliderUpdate,
-                0,
-                true,
-                {
-                    .slider = {
-                        "< CONTRAST",
-                        &gameController.lcd.contrast,
-                        0,
-                        255,
-                        10,
-                        &refreshContrast,
-                    }
-                },
-            };
-            break;
-        }
-        case Brightness: {
-            state = State {
-                &sliderUpdate,
-                0,
-                true,
-                {
-                    .slider = {
-                        "< BRIGHTNESS",
-                        &gameController.lcd.brightness,
-                        0,
-                        255,
-                        20,
-                        &refreshBrightness,
-                    }
-                },
-            };
-            break;
-        }
-        case Intensity: {
-            state = State {
-                &sliderUpdate,
-                0,
-                true,
-                {
-                    .slider = {
-                        "< INTENSITY",
-                        &gameController.matrix.intensity,
-                        0,
-                        15,
-                        1,
-                        &refreshIntensity,
-                    }
-                },
-            };
-            break;
-        }
-        case Sound: {
-            state = State {
-                &sliderUpdate,
-                0,
-                true,
-                {
-                    .slider = {
-                        "< SOUND",
-                        &soundIsEnabled,
-                        0,
-                        1,
-                        1,
-                        nullptr,
-                    }
-                },
-            };
-            break;
-        }
-        case DefaultState: {
-            state = State { &setDefaultState, {}, {}, {} };
-            break;
-        }
-        default:
-            UNREACHABLE;
-        }
+/* Lights the order's tile `idx`, or sets its shade of the gradient while reviewing */
+void showLevelTile(GameController& gc, const u8 idx, const u8 numTiles)
+{
+    const auto tile = levelTile(gc, idx);
+    if (MatrixGrayscale::isActive()) {
+        static constexpr u8 MAX_LEVEL = MatrixGrayscale::NUM_LEVELS - 1;
+        MatrixGrayscale::set(
+            u8(tile.y), u8(tile.x), u8(MAX_LEVEL - idx * MAX_LEVEL / numTiles));
+    } else {
+        gc.matrix.controller.setLed(0, tile.y, tile.x, true);
     }
-    if (input.joyDir == JoystickController::Direction::Left)
-        state = DEFAULT_MENU_STATE;
+    markDisplayWrite(gc);
 }
 
-void aboutUpdate(const Input& input)
+/* Moves the player and captures the tile pressed, false if it was not the next one in order */
+bool playMove(GameController& gc, const Input& input, const u8 numTiles)
 {
-    enum State : u8 {
-        Disengaged = 0,
-        Engaged,
-    };
-
-    enum AboutPosition : i8 {
-        GameName,
-        Author,
-        GitLink,
-        NumPositions,
-    };
-
-    static constexpr const char* DESCRIPTORS[NumPositions] = {
-        [GameName] = DOWN_ARROW_STR " Game Name",
-        [Author] = UP_DOWN_ARROW_STR " Author",
-        [GitLink] = "^ Github Link",
-    };
-    static constexpr Tiny::Pair<Tiny::String, Tiny::String> CONTENT[NumPositions] = {
-        [GameName] = { "Game Name", "Remember" },
-        [Author] = { "Author", "Nicula Ionut 334" },
-        [GitLink] = { "Git Link", "github.com/niculaionut/remember" },
-    };
+    auto& lc = gc.matrix.controller;
+    auto& params = gc.state.params.game;
 
-    auto& state = gameController.state;
-    auto& params = gameController.state.params.about;
+    highlightMovement(gc, input.joyDir);
 
-    if (state.entry) {
-        state.entry = false;
-
-        switch (params.subState) {
-        case Disengaged:
-            printfLCD(0, "<> %-13s", "ABOUT");
-            printfLCD(1, STR_FMT, DESCRIPTORS[params.pos]);
-            break;
-        case Engaged:
-            printfLCD(0, "< %-14s", params.header->ptr);
-            printfLCD(1, STR_FMT, params.content->ptr);
-            break;
-        }
+    const auto oldPos = params.player;
+    switch (input.joyDir) {
+    case JoystickController::Direction::Up:
+        ++params.player.y;
+        break;
+    case JoystickController::Direction::Down:
+        --params.player.y;
+        break;
+    case JoystickController::Direction::Left:
+        ++params.player.x;
+        break;
+    case JoystickController::Direction::Right:
+        --params.player.x;
+        break;
+    default:
+        break;
     }
 
-    highlightMovement(input.joyDir);
-
-    switch (params.subState) {
-    case Disengaged: {
-        const auto oldPos = params.pos;
+    params.player = params.player.clamp(0, GameController::MATRIX_SIZE - 1);
 
-        const i32 delta = input.joyDir == JoystickController::Direction::Up
-            ? -1
-            : (input.joyDir == JoystickController::Direction::Down ? 1 : 0);
-        params.pos = Tiny::clamp(i8(params.pos + delta), i8(0), i8(NumPositions - 1));
+    if (oldPos != params.player) {
+        const auto oldPosOrderIdx = Tiny::find(gc.levelOrder.buffers[gc.levelOrder.front],
+            u8(oldPos.x * MAT_SIZE + oldPos.y), [](u8 t1, u8 t2) { return t1 == t2; });
 
-        if (params.pos != oldPos)
-            printfLCD(1, STR_FMT, DESCRIPTORS[params.pos]);
-
-        if (input.joyDir == JoystickController::Direction::Left)
-            state = DEFAULT_MENU_STATE;
+        if (oldPosOrderIdx >= numTiles || oldPosOrderIdx < params.captured)
+            lc.setLed(0, oldPos.y, oldPos.x, false);
 
-        if (input.joyDir == JoystickController::Direction::Right) {
-            state.entry = true;
-            params.subState = Engaged;
-            params.header = &CONTENT[params.pos].first;
-            params.content = &CONTENT[params.pos].second;
-        }
-
-        break;
+        lc.setLed(0, params.player.y, params.player.x, true);
+        markDisplayWrite(gc);
     }
-    case Engaged: {
-        const auto oldShift = params.shift;
-        const i16 delta = input.joyDir == JoystickController::Direction::Up
-            ? -5
-            : (input.joyDir == JoystickController::Direction::Down ? 5 : 0);
-        params.shift = Tiny::clamp(params.shift + delta, i16(0), i16(params.content->len - 1));
 
-        if (params.shift != oldShift)
-            printfLCD(1, STR_FMT, params.content->ptr + params.shift);
+    if (input.joyPress == JoystickController::Press::Short
+        || input.joyPress == JoystickController::Press::Double) {
+        highlightPress(gc, input.joyPress);
 
-        if (input.joyDir == JoystickController::Direction::Left) {
-            state.entry = true;
-            params.subState = Disengaged;
-        }
-        break;
-    }
+        if (params.player != levelTile(gc, params.captured))
+            return false;
+        ++params.captured;
     }
+
+    return true;
 }
 
-void sliderUpdate(const Input& input)
+void sliderUpdate(GameController& gc, const Input& input)
 {
-    auto& state = gameController.state;
-    auto& params = gameController.state.params.slider;
+    auto& state = gc.state;
+    auto& params = gc.state.params.slider;
+    const auto slider = Tiny::readPgm(&SLIDERS[params.slider]);
 
     if (state.entry) {
         state.entry = false;
 
-        if (params.value == &gameController.matrix.intensity) {
-            for (i8 i = 0; i < GameController::MATRIX_SIZE; ++i) {
-                for (i8 j = 0; j < GameController::MATRIX_SIZE; ++j)
-                    gameController.matrix.controller.setLed(0, i, j, true);
-            }
+        if (params.value == &gc.matrix.intensity) {
+            for (u8 row = 0; row < GameController::MATRIX_SIZE; ++row)
+                gc.matrix.controller.setRow(0, row, 0xFF);
         }
 
-        printfLCD(0, STR_FMT, params.description);
-        printfLCD(1, "%-10c%6d", UP_DOWN_ARROW, *params.value);
+        printfLCD(gc, 0, "%-15s%c", slider.description, slider.icon);
+        printSliderValue(gc, slider, *params.value);
     }
 
-    highlightMovement(input.joyDir);
+    highlightMovement(gc, input.joyDir);
 
     const i32 delta = input.joyDir == JoystickController::Direction::Up
         ? 1
         : (input.joyDir == JoystickController::Direction::Down ? -1 : 0);
     const i32 newValue
-        = Tiny::clamp(*params.value + params.step * delta, params.min, params.max);
+        = Tiny::clamp(*params.value + slider.step * delta, slider.min, slider.max);
 
     if (*params.value != newValue) {
         *params.value = newValue;
-        printfLCD(1, "%-10c%6d", UP_DOWN_ARROW, newValue);
+        printSliderValue(gc, slider, newValue);
 
-        if (params.callback != nullptr)
-            params.callback(newValue);
+        if (slider.callback != nullptr)
+            slider.callback(gc, newValue);
     }
 
-    if (input.joyDir == JoystickController::Direction::Left) {
-        gameController.matrix.controller.clearDisplay(0);
-        state = { &settingsUpdate, 0, true, {} };
+    if (input.joyDir == JoystickController::Direction::Left && !input.joyRepeat) {
+        gc.matrix.controller.clearDisplay(0);
+        markDisplayWrite(gc);
+        state = menuState(params.menu, params.pos, input.currentTs);
+    }
+}
+
+/* The value as a bar graph with a resolution of one pixel column, then as a number */
+void printSliderValue(GameController& gc, const SliderEntry& slider, const i32 value)
+{
+    static constexpr u8 BAR_WIDTH = BAR_CELLS * BAR_CELL_WIDTH;
+    const i16 filled = i16((value - slider.min) * BAR_WIDTH / (slider.max - slider.min));
+
+    char bar[BAR_CELLS + 1];
+    for (u8 cell = 0; cell < BAR_CELLS; ++cell) {
+        const i16 cellFilled = i16(filled - cell * BAR_CELL_WIDTH);
+        if (cellFilled >= BAR_CELL_WIDTH)
+            bar[cell] = FULL_BLOCK;
+        else if (cellFilled > 0)
+            bar[cell] = char(Bar1 + cellFilled - 1);
+        else
+            bar[cell] = ' ';
     }
+    bar[BAR_CELLS] = '\0';
+
+    printfLCD(gc, 1, "%c%s%5d", UpDownArrow, bar, int(value));
 }
 
-void nameSelectionUpdate(const Input& input)
+void nameSelectionUpdate(GameController& gc, const Input& input)
 {
     static constexpr Tiny::String NAME_ALPHABET = " ABCDEFGHIJKLMNOPRSTUVWXYZ0123456789";
 
-    auto& state = gameController.state;
-    auto& params = gameController.state.params.nameSelection;
+    auto& state = gc.state;
+    auto& params = gc.state.params.nameSelection;
 
     if (state.entry) {
         state.entry = false;
 
-        printfLCD(0, STR_FMT, "Your name:");
-        printfLCD(1, STR_FMT, currentPlayer.name);
+        printfLCD(gc, 0, STR_FMT, "Your name:");
+        printfLCD(gc, 1, STR_FMT, gc.currentPlayer.name);
 
-        gameController.lcd.controller.setCursor(0, 1);
-        gameController.lcd.controller.blink();
+        gc.lcd.controller.setCursor(0, 1);
+        gc.lcd.controller.blink();
     }
 
-    highlightMovement(input.joyDir);
+    highlightMovement(gc, input.joyDir);
 
     i8 delta = input.joyDir == JoystickController::Direction::Left
         ? -1
@@ -779,7 +1043,7 @@ void nameSelectionUpdate(const Input& input)
     params.pos
         = Tiny::clamp(params.pos, i8(0), i8(GameController::LeaderboardEntry::NAME_SIZE - 1));
     if (params.pos != oldPos)
-        gameController.lcd.controller.setCursor(u8(params.pos), 1);
+        gc.lcd.controller.setCursor(u8(params.pos), 1);
 
     delta = input.joyDir == JoystickController::Direction::Down
         ? -1
@@ -787,125 +1051,438 @@ void nameSelectionUpdate(const Input& input)
     if (delta) {
         i16 currentCharIdx = 0;
         for (i8 i = 0; i < i8(NAME_ALPHABET.len); ++i) {
-            if (currentPlayer.name[params.pos] == NAME_ALPHABET.ptr[i])
+            if (gc.currentPlayer.name[params.pos] == NAME_ALPHABET.ptr[i])
                 currentCharIdx = i;
         }
 
-        currentCharIdx = Tiny::clamp(currentCharIdx + delta, 0, i16(NAME_ALPHABET.len - 1));
+        currentCharIdx
+            = Tiny::clamp(i16(currentCharIdx + delta), i16(0), i16(NAME_ALPHABET.len - 1));
         const char letter = NAME_ALPHABET.ptr[currentCharIdx];
 
-        currentPlayer.name[params.pos] = letter;
-        gameController.lcd.controller.print(letter);
-        gameController.lcd.controller.setCursor(u8(params.pos), 1);
+        gc.currentPlayer.name[params.pos] = letter;
+        gc.lcd.controller.print(letter);
+        gc.lcd.controller.setCursor(u8(params.pos), 1);
+        markDisplayWrite(gc);
     }
 
     if (u8(input.joyPress)) {
         for (i8 i = GameController::LEADERBOARD_SIZE - 1; i >= params.rank + 1; --i)
-            gameController.leaderboard[i] = gameController.leaderboard[i - 1];
-        gameController.leaderboard[params.rank] = currentPlayer;
+            gc.leaderboard[i] = gc.leaderboard[i - 1];
+        gc.leaderboard[params.rank] = gc.currentPlayer;
 
-        highlightPress(input.joyPress);
-        saveToStorage();
+        highlightPress(gc, input.joyPress);
+        saveToStorage(gc);
 
-        gameController.lcd.controller.noBlink();
+        gc.lcd.controller.noBlink();
         state = DEFAULT_MENU_STATE;
     }
 }
 
-void leaderboardUpdate(const Input& input)
+/* In the background: the settings and the leaderboard are members, so they stay valid */
+void saveToStorage(GameController& gc)
 {
-    auto& state = gameController.state;
-    auto& params = gameController.state.params.leaderboard;
+    u16 eepromAddr = 0;
+    for (const auto& data : storageData(gc)) {
+        EepromWriter::write(eepromAddr, data.addr, u8(data.size));
+        eepromAddr = u16(eepromAddr + data.size);
+    }
+}
 
-    if (state.entry) {
-        state.entry = false;
+void highlightMovement(GameController& gc, const JoystickController::Direction joyDir)
+{
+    if (u8(joyDir) && gc.soundIsEnabled)
+        Buzzer::play(MOVE_SOUND);
+}
+
+void highlightPress(GameController& gc, const JoystickController::Press joyPress)
+{
+    if (u8(joyPress) && gc.soundIsEnabled)
+        Buzzer::play(PRESS_SOUND);
+}
 
-        auto& entry = gameController.leaderboard[state.params.leaderboard.pos];
-        printfLCD(0, STR_FMT, UP_DOWN_ARROW_STR "LEADERBOARD <");
-        printfLCD(
-            1, "%1d. %-10s %2d", state.params.leaderboard.pos + 1, entry.name, entry.score);
+void markDisplayWrite(GameController& gc) { gc.latency.onDisplayWrite(micros()); }
+
+void accountTraffic(GameController& gc, const UpdateFunc updateFunc, const u16 lcdBytes,
+    const u16 matrixBytes, const u32 currentTs)
+{
+    static constexpr u32 WINDOW = 1000;
+
+    auto& traffic = gc.traffic;
+
+    if constexpr (Log::isEnabled(LogId::BusOverBudget)) {
+        if (lcdBytes > GameController::LCD_FRAME_BUDGET
+            || matrixBytes > GameController::MATRIX_FRAME_BUDGET) {
+            Log::write<LogId::BusOverBudget>(
+                u16(reinterpret_cast<uintptr_t>(updateFunc)), lcdBytes, matrixBytes);
+        }
     }
 
-    highlightMovement(input.joyDir);
+    if constexpr (Log::isEnabled(LogId::BusTraffic)) {
+        traffic.lcdBytes = u16(traffic.lcdBytes + lcdBytes);
+        traffic.matrixBytes = u16(traffic.matrixBytes + matrixBytes);
+        traffic.lcdFrameMax = max(traffic.lcdFrameMax, lcdBytes);
+        traffic.matrixFrameMax = max(traffic.matrixFrameMax, matrixBytes);
 
-    const i8 delta = input.joyDir == JoystickController::Direction::Up
-        ? -1
-        : (input.joyDir == JoystickController::Direction::Down ? 1 : 0);
-    const auto newPos
-        = i8(Tiny::clamp(params.pos + delta, 0, GameController::LEADERBOARD_SIZE - 1));
+        if (currentTs - traffic.windowBeginTs >= WINDOW) {
+            Log::write<LogId::BusTraffic>(traffic.lcdBytes, traffic.lcdFrameMax,
+                traffic.matrixBytes, traffic.matrixFrameMax);
+            traffic = { currentTs, 0, 0, 0, 0 };
+        }
+    }
+}
 
-    if (newPos != params.pos) {
-        params.pos = newPos;
+/*
+ *  Draws up to `maxDraws` more tiles of the order of `level` into the back buffer, and tells
+ *  whether the order is complete. The order only depends on the seed and the level, so a
+ *  checkpoint can regenerate it, and drawing it in slices doesn't change it.
+ */
+bool prepareLevelOrder(GameController& gc, const u32 seed, const u8 level, const u8 numTiles,
+    const u8 maxDraws)
+{
+    auto& levelOrder = gc.levelOrder;
+    auto& back = levelOrder.buffers[levelOrder.front ^ 1];
+
+    if (levelOrder.backSeed != seed || levelOrder.backLevel != level) {
+        for (u8 i = 0; i < MAT_SIZE * MAT_SIZE; ++i)
+            back[i] = i;
+
+        levelOrder.backSeed = seed;
+        levelOrder.backLevel = level;
+        levelOrder.backDrawn = 0;
+        levelOrder.rngState = Tiny::Random(seed ^ (level * 0x9E3779B9UL)).state;
+        return false;
+    }
 
-        auto& entry = gameController.leaderboard[state.params.leaderboard.pos];
-        printfLCD(
-            1, "%1d. %-10s %2d", state.params.leaderboard.pos + 1, entry.name, entry.score);
+    /* Only the tiles the level shows need to be drawn, the rest can stay in place */
+    const u8 end = u8(min(u16(numTiles), u16(levelOrder.backDrawn + maxDraws)));
+    Tiny::Random rng(levelOrder.rngState);
+    Tiny::shufflePrefix(back, levelOrder.backDrawn, end, rng);
+    levelOrder.backDrawn = end;
+    levelOrder.rngState = rng.state;
+
+    return levelOrder.backDrawn == numTiles;
+}
+
+/* Finishes the order of `level` if the idle frames didn't, then brings it to the front */
+void useLevelOrder(GameController& gc, const u32 seed, const u8 level, const u8 numTiles)
+{
+    while (!prepareLevelOrder(gc, seed, level, numTiles, numTiles))
+        ;
+
+    gc.levelOrder.front ^= 1;
+    gc.levelOrder.backLevel = 0;
+}
+
+Position levelTile(const GameController& gc, const u8 idx)
+{
+    const u8 tile = gc.levelOrder.buffers[gc.levelOrder.front][idx];
+    return { i8(tile / MAT_SIZE), i8(tile % MAT_SIZE) };
+}
+
+/*
+ *  Checkpoints alternate between two slots, so that the previous one survives a write cut
+ *  short by a power loss. Only changed bytes are written, in address order, so the CRC goes
+ *  last and a torn slot is rejected.
+ */
+void saveCheckpoint(GameController& gc)
+{
+    const auto& params = gc.state.params.game;
+    auto& checkpoints = gc.checkpoints;
+    auto& checkpoint = checkpoints.slots[checkpoints.next];
+    checkpoint = {
+        params.seed,
+        params.level,
+        params.score,
+        params.totalReviews,
+        checkpoints.seq,
+        0,
+    };
+    checkpoint.crc = Tiny::crc8(&checkpoint, offsetof(Checkpoint, crc));
+
+    const auto addr = u16(CHECKPOINT_ADDR + checkpoints.next * sizeof(Checkpoint));
+    EepromWriter::write(addr, &checkpoint, sizeof(checkpoint));
+
+    checkpoints.next = u8((checkpoints.next + 1) % GameController::NUM_CHECKPOINT_SLOTS);
+    ++checkpoints.seq;
+}
+
+/* The newest valid checkpoint; the next one goes to the other slot */
+bool loadCheckpoint(GameController& gc, Checkpoint& checkpoint)
+{
+    auto& checkpoints = gc.checkpoints;
+    bool found = false;
+    for (u8 slot = 0; slot < GameController::NUM_CHECKPOINT_SLOTS; ++slot) {
+        auto& candidate = checkpoints.slots[slot];
+        EepromWriter::read(
+            u16(CHECKPOINT_ADDR + slot * sizeof(Checkpoint)), &candidate, sizeof(candidate));
+
+        const bool valid = candidate.level
+            && candidate.crc == Tiny::crc8(&candidate, offsetof(Checkpoint, crc));
+        if (valid && (!found || i8(candidate.seq - checkpoint.seq) > 0)) {
+            checkpoint = candidate;
+            checkpoints.next = u8((slot + 1) % GameController::NUM_CHECKPOINT_SLOTS);
+            checkpoints.seq = u8(candidate.seq + 1);
+            found = true;
+        }
     }
 
-    if (input.joyDir == JoystickController::Direction::Left)
-        state = DEFAULT_MENU_STATE;
+    return found;
 }
 
-void saveToStorage()
+/* Both slots, or the older one would be offered instead */
+void clearCheckpoint(GameController& gc)
 {
-    size_t eepromAddr = 0;
-    for (const auto& data : STORAGE_DATA) {
-        writeEEPROM(eepromAddr, data.addr, data.size);
-        eepromAddr += data.size;
+    for (u8 slot = 0; slot < GameController::NUM_CHECKPOINT_SLOTS; ++slot) {
+        auto& checkpoint = gc.checkpoints.slots[slot];
+        checkpoint.level = 0;
+        EepromWriter::write(
+            u16(CHECKPOINT_ADDR + slot * sizeof(Checkpoint) + offsetof(Checkpoint, level)),
+            &checkpoint.level, sizeof(checkpoint.level));
     }
 }
 
-void highlightMovement(const JoystickController::Direction joyDir)
+void resumeUpdate(GameController& gc, const Input& input)
 {
-    if (u8(joyDir) && soundIsEnabled)
-        tone(MelodyPlayer::BUZZER_PIN, NOTE_FS3, INPUT_SOUND_DUR);
+    auto& state = gc.state;
+    auto& params = gc.state.params.game;
+
+    if (state.entry) {
+        state.entry = false;
+
+        printfLCD(gc, 0, "Resume level %-3d", params.level);
+        printfLCD(gc, 1, "%-8s%8s", "< No", "Yes >");
+    }
+
+    highlightMovement(gc, input.joyDir);
+
+    if (input.joyDir == JoystickController::Direction::Right && !input.joyRepeat) {
+        params.gameBeginTs = input.currentTs;
+        state.updateFunc = &gameUpdate<ActiveRules>;
+        state.beginTs = input.currentTs;
+        state.entry = true;
+    }
+    if (input.joyDir == JoystickController::Direction::Left && !input.joyRepeat) {
+        clearCheckpoint(gc);
+        state = { &greetUpdate, input.currentTs, true, {} };
+    }
 }
 
-void highlightPress(const JoystickController::Press joyPress)
+/* The LCD on its own pins (set in its type), or behind its I2C backpack */
+GameController::LcdController makeLcdController()
 {
-    if (u8(joyPress) && soundIsEnabled)
-        tone(MelodyPlayer::BUZZER_PIN, NOTE_FS7, INPUT_SOUND_DUR);
+#if LCD_BACKEND == LCD_BACKEND_I2C
+    return GameController::LcdController(GameController::LCD_I2C_ADDRESS);
+#else
+    return GameController::LcdController();
+#endif
 }
 
 GameController::GameController()
-    : lcd({ { RS_PIN, ENABLE_PIN, D4, D5, D6, D7 }, {}, {} })
-    , matrix({ { DIN_PIN, CLOCK_PIN, LOAD_PIN, 1 }, DEFAULT_MATRIX_INTENSITY })
+    : lcd({ makeLcdController(), { GLYPHS, NumGlyphs - 1 }, {}, {} })
+    , matrix({ { DIN_PIN, CLOCK_PIN, LOAD_PIN, 1 }, DEFAULT_MATRIX_INTENSITY, {} })
+    , soundIsEnabled(SOUND_IS_ENABLED_DEFAULT)
+    , currentPlayer({ "         ", 0 })
+    , printfBuffer()
+    , levelOrder()
+    , melodyPlayer(CONTRAPUNCTUS_1, GREET_MELODY_DURATION)
+    , latency()
+    , nextLatencyLog(0)
+    , stack()
+    , lastInputTs(0)
+    , checkpoints()
+    , traffic()
 {
 }
 
 void GameController::init()
 {
-    /* Fill index lists */
-    for (i8 i = 0; i < GameController::MATRIX_SIZE * GameController::MATRIX_SIZE; ++i)
-        matrixOrder[size_t(i)] = Position { i8(i / 8), i8(i % 8) };
-
-    /* Read game info/settings from storage */
-    size_t eepromAddr = 0;
-    for (const auto& data : STORAGE_DATA) {
-        readEEPROM(eepromAddr, data.addr, data.size);
-        eepromAddr += data.size;
+    /* Read game info/settings from storage, with one block read, then spread them */
+    u8 settings[SETTINGS_SIZE];
+    EepromWriter::read(0, settings, sizeof(settings));
+    size_t offset = 0;
+    for (const auto& data : storageData(*this)) {
+        memcpy(data.addr, &settings[offset], data.size);
+        offset += data.size;
     }
 
-    /* Initialize the matrix display */
+    /* The matrix comes up first: it shows the first frame while the rest is set up */
     matrix.controller.shutdown(0, false);
     matrix.controller.setIntensity(0, i16(matrix.intensity));
     matrix.controller.clearDisplay(0);
 
-    /* Initialize the LCD */
-    lcd.controller.begin(NUM_COLS, NUM_ROWS);
+    /* The LCD's power-on sequence goes on in `update`, a step per frame */
+    lcd.controller.beginTwoLines();
+    lcd.glyphs.clear();
 
     pinMode(CONTRAST_PIN, OUTPUT);
     pinMode(BRIGHTNESS_PIN, OUTPUT);
     analogWrite(CONTRAST_PIN, i16(lcd.contrast));
     analogWrite(BRIGHTNESS_PIN, i16(lcd.brightness));
 
-    for (auto& specialChar : SPECIAL_CHARS)
-        lcd.controller.createChar(u8(specialChar.id), specialChar.data);
+    Buzzer::init();
+    stats.init();
+
+    /* Initialize the default state, or offer to resume a game that a reset interrupted */
+    Checkpoint checkpoint {};
+    if (loadCheckpoint(*this, checkpoint)) {
+        /* The game restarts from the top of its coroutine, which rebuilds the level's order */
+        state = { &resumeUpdate, 0, true, {} };
+        state.params.game.level = checkpoint.level;
+        state.params.game.score = checkpoint.score;
+        state.params.game.totalReviews = checkpoint.totalReviews;
+        state.params.game.seed = checkpoint.seed;
+    } else {
+        state = { &greetUpdate, 0, true, {} };
+    }
+}
+
+void GameController::update(const Input& input)
+{
+    /* The states write to the LCD: they start once it is initialized */
+    if (!lcd.controller.poll())
+        return;
+
+    if (u8(input.joyPress) || u8(input.joyDir)) {
+        latency.onInput(state.updateFunc, input.sampleUs);
+        lastInputTs = input.currentTs;
+    }
+
+    const auto updateFunc = state.updateFunc;
+    const auto lcdBytes = lcd.controller.bytes;
+    const auto matrixBytes = matrix.controller.bytes;
+    state.updateFunc(*this, input);
+    matrix.animator.update(matrix.controller, input.currentTs);
+    accountTraffic(*this, updateFunc, u16(lcd.controller.bytes - lcdBytes),
+        u16(matrix.controller.bytes - matrixBytes), input.currentTs);
+
+    if (state.updateFunc != updateFunc) {
+        Log::write<LogId::StateEnter>(u16(reinterpret_cast<uintptr_t>(state.updateFunc)));
+
+        /* Every state is measured on its own, against paint laid when it was entered */
+        const u16 free = Stack::unused();
+        if (stack.record(updateFunc, free))
+            Log::write<LogId::StackLow>(u16(reinterpret_cast<uintptr_t>(updateFunc)), free);
+        Stack::repaint();
+    }
+}
+
+/* Whether the states run, which they do once the LCD is initialized */
+bool GameController::isReady()
+{
+    return lcd.controller.poll();
+}
+
+/* The latency percentiles of one state per call, in turn, so that the log keeps up */
+void GameController::logLatency()
+{
+    for (u8 i = 0; i < NUM_LATENCY_SLOTS; ++i) {
+        const auto& slot = latency.slots[nextLatencyLog];
+        nextLatencyLog = u8((nextLatencyLog + 1) % NUM_LATENCY_SLOTS);
+
+        if (slot.key != UpdateFunc {}) {
+            const auto& histogram = slot.histogram;
+            Log::write<LogId::LatencyP95>(u16(reinterpret_cast<uintptr_t>(slot.key)),
+                histogram.percentile(50), histogram.percentile(95), histogram.maxUs,
+                histogram.total);
+            return;
+        }
+    }
+}
+
+/* The name of `state` on the diagnostics screens (up to NUM_COLS), false if it has none */
+bool GameController::stateName(const UpdateFunc state, char* const name)
+{
+    for (const auto& entry : STATE_NAMES) {
+        const auto stateName = Tiny::readPgm(&entry);
+        if (stateName.state == state) {
+            memcpy(name, stateName.name, sizeof(stateName.name));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool GameController::isInactive(const u32 currentTs) const
+{
+    /* States that only wait for input, so that sleeping in them loses nothing */
+    static constexpr UpdateFunc IDLE_STATES[] = {
+        &greetUpdate,
+        &menuUpdate,
+        &textUpdate,
+        &resumeUpdate,
+    };
+
+    if (currentTs - lastInputTs < INACTIVITY_TIMEOUT)
+        return false;
+
+    for (const auto idleState : IDLE_STATES) {
+        if (state.updateFunc == idleState)
+            return true;
+    }
+
+    return false;
+}
 
-    lcd.controller.clear();
+void GameController::sleep()
+{
+    Log::write<LogId::Sleep>();
+    Log::flush();
+
+    /* A write cut short would corrupt its byte */
+    EepromWriter::drain();
+
+    /* The display contents survive: the MAX7219 and the HD44780 keep their RAM */
+    melodyPlayer.stop();
+    Buzzer::silence();
+    matrix.controller.shutdown(0, true);
+    lcd.controller.noDisplay();
+    lcd.controller.flush();
+    analogWrite(BRIGHTNESS_PIN, 0);
+    analogWrite(CONTRAST_PIN, 0);
 
-    /* Initialize the default state */
-    state = { &greetUpdate, 0, true, {} };
+    Power::powerDown(JoystickController::BUTTON_PIN);
+
+    const auto wakeUs = micros();
+    analogWrite(CONTRAST_PIN, i16(lcd.contrast));
+    analogWrite(BRIGHTNESS_PIN, i16(lcd.brightness));
+    lcd.controller.display();
+    matrix.controller.shutdown(0, false);
+    Log::write<LogId::Wake>(u32(micros() - wakeUs));
+
+    /* `millis()` stood still while asleep */
+    lastInputTs = millis();
+}
+
+/* A new game under `Rules`, from level 1, seeded with the time */
+template <typename Rules> GameController::State GameController::gameState(const u32 beginTs)
+{
+    return {
+        &gameUpdate<Rules>,
+        beginTs,
+        true,
+        {
+            .game = {
+                { 0, 0 },
+                0,
+                {},
+                1,
+                0,
+                0,
+                0,
+                0,
+                beginTs,
+                u32(micros()),
+            }
+        },
+    };
 }
 
-void GameController::update(const Input& input) { state.updateFunc(input); }
+/*
+ *  The build plays ActiveRules; the other modes are built too, for the host benchmark to run
+ *  them side by side (see tests/rules_test.cpp), and the AVR link drops them unused.
+ */
+template GameController::State GameController::gameState<GameRules::Classic>(u32);
+template GameController::State GameController::gameState<GameRules::Speed>(u32);
+template GameController::State GameController::gameState<GameRules::Hardcore>(u32);
+template GameController::State GameController::gameState<GameRules::Zen>(u32);
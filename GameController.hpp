@@ -1,21 +1,32 @@
 #pragma once
-#include "EEPROM.h"
+#include "BusTraffic.hpp"
+#include "Coroutine.hpp"
+#include "GlyphCache.hpp"
 #include "JoystickController.hpp"
-#include "LedControl.h"
-#include "LiquidCrystal.h"
+#include "LatencyMonitor.hpp"
+#include "Lcd.hpp"
+#include "MatrixAnimator.hpp"
+#include "MelodyPlayer.hpp"
+#include "StackMonitor.hpp"
+#include "StatsLog.hpp"
+
+/* Forward declarations */
+struct GameController;
 
 /* Structs */
 struct Input {
     u32 currentTs;
+    u32 sampleUs;
     JoystickController::Press joyPress;
     JoystickController::Direction joyDir;
+    bool joyRepeat;
 };
 
 /* Typedefs */
 using i8 = int8_t;
 using i16 = int16_t;
 using i32 = int32_t;
-using UpdateFunc = void (*)(const Input& input);
+using UpdateFunc = void (*)(GameController&, const Input& input);
 
 struct GameController {
 public:
@@ -38,27 +49,27 @@ public:
     };
 
     /* Structs for the state union */
-    struct MainMenuParams {
+    struct MenuParams {
+        u8 menu;
         i8 pos;
     };
     struct GameParams {
         Position player;
         u8 tileIdx;
-        u8 subState;
+        Coroutine co;
         u8 level;
         u8 captured;
         u8 score;
         u8 usedReviews;
-    };
-    struct SettingsParams {
-        i8 pos;
+        u8 totalReviews;
+        u32 gameBeginTs;
+        u32 seed;
     };
     struct SettingSliderParams {
-        const char* description;
+        u8 slider;
         i32* value;
-        i32 min, max;
-        i32 step;
-        void (*callback)(i32);
+        u8 menu;
+        i8 pos;
     };
     struct GameOverParams {
         u8 score;
@@ -70,29 +81,34 @@ public:
         i8 pos;
         i8 rank;
     };
-    struct LeaderboardUpdateParams {
+    struct TextParams {
+        u8 text;
+        i16 shift;
+        u8 menu;
         i8 pos;
+        Coroutine co;
     };
-    struct AboutUpdateParams {
-        u8 subState;
-        i8 pos;
-        i16 shift;
-        const Tiny::String* header;
-        const Tiny::String* content;
+    /* The game as saved in the EEPROM at the start of every level */
+    struct Checkpoint {
+        u32 seed;
+        u8 level;
+        u8 score;
+        u8 totalReviews;
+        /* Tells the newer of the two slots, modulo 256 */
+        u8 seq;
+        u8 crc;
     };
     struct State {
         UpdateFunc updateFunc;
         u32 beginTs;
         bool entry;
         union {
-            MainMenuParams mainMenu;
+            MenuParams menu;
             GameParams game;
-            SettingsParams settings;
             SettingSliderParams slider;
             GameOverParams gameOver;
             NameSelectionParams nameSelection;
-            LeaderboardUpdateParams leaderboard;
-            AboutUpdateParams about;
+            TextParams text;
         } params;
     };
 
@@ -100,6 +116,12 @@ public:
     GameController();
     void init();
     void update(const Input&);
+    bool isReady();
+    bool isInactive(u32) const;
+    void sleep();
+    void logLatency();
+    static bool stateName(UpdateFunc, char* name);
+    template <typename Rules> static State gameState(u32 beginTs);
 
     /* Static constexpr variables */
     static constexpr u8 DIN_PIN = 12;
@@ -112,6 +134,8 @@ public:
     static constexpr u8 D5 = A3;
     static constexpr u8 D6 = A4;
     static constexpr u8 D7 = A5;
+    static constexpr u8 LCD_I2C_ADDRESS = 0x27;
+    using LcdController = LcdDriver<RS_PIN, ENABLE_PIN, D4, D5, D6, D7>;
     static constexpr u8 NUM_ROWS = 2;
     static constexpr u8 NUM_COLS = 16;
     static constexpr u8 CONTRAST_PIN = 6;
@@ -121,6 +145,16 @@ public:
     static constexpr i32 DEFAULT_MATRIX_INTENSITY = 8;
     static constexpr u8 LEADERBOARD_SIZE = 5;
     static constexpr u8 MAX_LEVEL_AMOUNT = MATRIX_SIZE * MATRIX_SIZE;
+    static constexpr u8 PRINTF_BUFSIZE = NUM_COLS + 1;
+    static constexpr u16 GREET_MELODY_DURATION = 10000;
+    static constexpr u8 NUM_CHECKPOINT_SLOTS = 2;
+    /* State functions, one per entry of the state name table (checked where it is defined) */
+    static constexpr u8 NUM_STATES = 10;
+    static constexpr u8 NUM_LATENCY_SLOTS = NUM_STATES;
+    static constexpr u8 NUM_STACK_SLOTS = NUM_STATES;
+    static constexpr u32 INACTIVITY_TIMEOUT = 120000;
+    static constexpr u16 LCD_FRAME_BUDGET = 40 * LcdController::BUS_BYTES;
+    static constexpr u16 MATRIX_FRAME_BUDGET = 40;
     static constexpr LeaderboardEntry LEADERBOARD_ENTRY_NONE = { "**********", 0 };
     static constexpr LeaderboardEntry DEFAULT_LEADERBOARD[] = {
         LEADERBOARD_ENTRY_NONE,
@@ -133,16 +167,53 @@ public:
 public:
     /* Data members */
     struct {
-        LiquidCrystal controller;
+        LcdController controller;
+        GlyphCache glyphs;
         i32 contrast;
         i32 brightness;
     } lcd;
     struct {
-        LedControl controller;
+        MatrixBus controller;
         i32 intensity;
+        MatrixAnimator animator;
     } matrix;
     State state;
     LeaderboardEntry leaderboard[LEADERBOARD_SIZE];
+    i32 soundIsEnabled;
+    LeaderboardEntry currentPlayer;
+    char printfBuffer[PRINTF_BUFSIZE];
+    /*
+     *  Tiles (x * MATRIX_SIZE + y) in the order a level shows them. The front buffer holds the
+     *  current level's order; the back one the next level's, drawn a few tiles at a time in
+     *  idle frames.
+     */
+    struct {
+        Tiny::Array<u8, MATRIX_SIZE * MATRIX_SIZE> buffers[2];
+        u8 front;
+        u32 backSeed;
+        u8 backLevel;
+        u8 backDrawn;
+        u32 rngState;
+    } levelOrder;
+    MelodyPlayer melodyPlayer;
+    LatencyMonitor<UpdateFunc, NUM_LATENCY_SLOTS> latency;
+    /* The latency slot that `logLatency` looks at first */
+    u8 nextLatencyLog;
+    StackMonitor<UpdateFunc, NUM_STACK_SLOTS> stack;
+    u32 lastInputTs;
+    StatsLog stats;
+    struct {
+        /* Sources of the checkpoint writes, which happen in the background, one per slot */
+        Checkpoint slots[NUM_CHECKPOINT_SLOTS];
+        /* The slot the next checkpoint goes to: the older one, as found at boot */
+        u8 next;
+        u8 seq;
+    } checkpoints;
+    struct {
+        u32 windowBeginTs;
+        u16 lcdBytes;
+        u16 matrixBytes;
+        u16 lcdFrameMax;
+        u16 matrixFrameMax;
+    } traffic;
 };
-
-extern GameController gameController;
@@ -0,0 +1,76 @@
+#pragma once
+#include "utils.hpp"
+
+/*
+ *  Game modes as policy types: every tunable of the game and of the joystick is a static
+ *  constexpr member, and the code that uses them is templated on (or built against) one
+ *  policy, so a mode costs nothing at run time. The mode of a build is chosen with
+ *  `-DGAME_RULES=<name>` (see the Makefile).
+ */
+namespace GameRules {
+struct Classic {
+    /* Time each tile of a level is shown for (ms) */
+    static constexpr u32 SHOW_TIME = 500;
+
+    /* Reviews start at `REVIEWS` and decrease by one every `REVIEW_DECAY` levels */
+    static constexpr u8 REVIEWS = 4;
+    static constexpr u8 MIN_REVIEWS = 1;
+    static constexpr u8 REVIEW_DECAY = 4;
+
+    /* Tiles shown by the longest level */
+    static constexpr u8 MAX_TILES = 64;
+
+    /*
+     *  Joystick deflections from the middle of the ADC range: past the first one the stick
+     *  moves, within the second it is released, and past the third a move on the other axis
+     *  is ignored.
+     */
+    static constexpr u16 AXIS_DELTA_THRESHOLD = 400;
+    static constexpr u16 RESET_DELTA_THRESHOLD = 80;
+    static constexpr u16 NON_CONFLICT_DELTA_THRESHOLD = 200;
+};
+
+/* Shorter shows and a more sensitive stick */
+struct Speed : Classic {
+    static constexpr u32 SHOW_TIME = 250;
+    static constexpr u16 AXIS_DELTA_THRESHOLD = 300;
+    static constexpr u16 NON_CONFLICT_DELTA_THRESHOLD = 150;
+};
+
+/* No reviews at all */
+struct Hardcore : Classic {
+    static constexpr u8 REVIEWS = 0;
+    static constexpr u8 MIN_REVIEWS = 0;
+};
+
+/* Slow shows and as many reviews as the screen can count */
+struct Zen : Classic {
+    static constexpr u32 SHOW_TIME = 800;
+    static constexpr u8 REVIEWS = 99;
+    static constexpr u8 MIN_REVIEWS = 99;
+};
+
+template <typename Rules> constexpr u8 maxReviews(const u8 level)
+{
+    return level / Rules::REVIEW_DECAY >= Rules::REVIEWS - Rules::MIN_REVIEWS
+        ? Rules::MIN_REVIEWS
+        : u8(Rules::REVIEWS - level / Rules::REVIEW_DECAY);
+}
+
+template <typename Rules> constexpr u8 numTiles(const u8 level)
+{
+    return level < Rules::MAX_TILES ? level : u8(Rules::MAX_TILES);
+}
+
+static_assert(maxReviews<Classic>(1) == 4 && maxReviews<Classic>(8) == 2
+        && maxReviews<Classic>(100) == 1,
+    "Classic keeps the original review formula");
+static_assert(maxReviews<Hardcore>(1) == 0 && maxReviews<Zen>(200) == 99,
+    "The review formula handles flat limits");
+}
+
+#ifndef GAME_RULES
+#define GAME_RULES Classic
+#endif
+
+using ActiveRules = GameRules::GAME_RULES;
@@ -0,0 +1,61 @@
+#include "GlyphCache.hpp"
+
+void GlyphCache::beginRow(const u8 row)
+{
+    for (auto& slotRows : rows)
+        slotRows &= u8(~(1 << row));
+}
+
+void GlyphCache::clear()
+{
+    memset(rows, 0, sizeof(rows));
+}
+
+/* The slot that holds `glyph`, or its slot ORed with `MISS` and the bitmap to upload there */
+u8 GlyphCache::lookup(const char glyph, const u8 row, Bitmap& upload)
+{
+    ++clock;
+
+    u8 slot = 0;
+    while (slot < NUM_SLOTS && glyphs[slot] != u8(glyph))
+        ++slot;
+
+    u8 miss = 0;
+    if (slot < NUM_SLOTS) {
+        ++hits;
+    } else {
+        ++misses;
+        slot = victim();
+        glyphs[slot] = u8(glyph);
+        rows[slot] = 0;
+
+        /* Unknown ids are uploaded blank rather than read past the table */
+        upload = {};
+        if (u8(glyph) <= numGlyphs)
+            upload = Tiny::readPgm(&bitmaps[glyph - 1]);
+        miss = MISS;
+    }
+
+    rows[slot] |= u8(1 << row);
+    lastUse[slot] = clock;
+    return u8(slot | miss);
+}
+
+/*
+ *  The least recently used slot, preferring the ones no row shows. Ages are counted in lookups
+ *  modulo 256, which is plenty for a screen of 32 characters.
+ */
+u8 GlyphCache::victim() const
+{
+    u8 best = 0;
+    for (u8 slot = 1; slot < NUM_SLOTS; ++slot) {
+        const bool shown = rows[slot] != 0;
+        const bool bestShown = rows[best] != 0;
+        const bool older = u8(clock - lastUse[slot]) > u8(clock - lastUse[best]);
+
+        if ((bestShown && !shown) || (shown == bestShown && older))
+            best = slot;
+    }
+
+    return best;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "utils.hpp"
+#include <avr/pgmspace.h>
+
+/*
+ *  Maps logical glyph ids to the 8 CGRAM slots of the HD44780, so that screens can use more
+ *  custom glyphs than the display holds at once. A glyph is uploaded only when it is not in
+ *  a slot already (a miss); then it replaces the least recently used glyph.
+ *
+ *  The display shows CGRAM live: rewriting a slot changes every character on screen that
+ *  uses it. So the cache remembers which rows use every slot (`beginRow` forgets a row that
+ *  is about to be rewritten) and only evicts a glyph still on screen when all of them are.
+ *
+ *  Glyph ids are the control characters 1..31, so that they can be embedded in strings;
+ *  `get` returns the character code of the slot (0..7) to send instead.
+ */
+class GlyphCache {
+public:
+    struct Bitmap {
+        u8 rows[8];
+    };
+
+    /* `bitmaps` is in program memory and indexed by glyph id - 1 */
+    constexpr GlyphCache(const Bitmap* bitmaps, const u8 numGlyphs)
+        : bitmaps(bitmaps)
+        , numGlyphs(numGlyphs)
+    {
+    }
+
+    static constexpr bool isGlyph(const char c) { return u8(u8(c) - 1) < MAX_GLYPHS; }
+
+    void beginRow(u8 row);
+    void clear();
+
+    template <typename Lcd> char get(Lcd& lcd, const char glyph, const u8 row)
+    {
+        Bitmap bitmap;
+        const u8 slot = lookup(glyph, row, bitmap);
+        if (slot & MISS)
+            lcd.createChar(slot & u8(~MISS), bitmap.rows);
+
+        return char(slot & u8(~MISS));
+    }
+
+    static constexpr u8 NUM_SLOTS = 8;
+    static constexpr u8 MAX_GLYPHS = 31;
+
+private:
+    u8 lookup(char glyph, u8 row, Bitmap& upload);
+    u8 victim() const;
+
+    /* Set in the slot `lookup` returns when the glyph has to be uploaded to it */
+    static constexpr u8 MISS = 0x80;
+
+private:
+    const Bitmap* bitmaps;
+    u8 numGlyphs;
+    u8 clock = 0;
+    u8 glyphs[NUM_SLOTS] = {};
+    u8 rows[NUM_SLOTS] = {};
+    u8 lastUse[NUM_SLOTS] = {};
+
+public:
+    u16 hits = 0;
+    u16 misses = 0;
+};
@@ -1,107 +1,232 @@
 #include "JoystickController.hpp"
+#include "GameRules.hpp"
+#include <avr/interrupt.h>
+
+/* Axis thresholds */
+static constexpr Tiny::Pair<u16, u16> INPUT_RANGE = {
+    0,
+    1023,
+};
+static constexpr u16 INPUT_MIDDLE = INPUT_RANGE.second / 2;
+static constexpr u16 AXIS_DELTA_THRESHOLD = ActiveRules::AXIS_DELTA_THRESHOLD;
+static constexpr u16 RESET_DELTA_THRESHOLD = ActiveRules::RESET_DELTA_THRESHOLD;
+static constexpr u16 NON_CONFLICT_DELTA_THRESHOLD = ActiveRules::NON_CONFLICT_DELTA_THRESHOLD;
+static constexpr u16 AXIS_MIN_THRESHOLD = INPUT_MIDDLE - AXIS_DELTA_THRESHOLD;
+static constexpr u16 AXIS_MAX_THRESHOLD = INPUT_MIDDLE + AXIS_DELTA_THRESHOLD;
+static constexpr Tiny::Pair<u16, u16> RESET_RANGE = {
+    INPUT_MIDDLE - RESET_DELTA_THRESHOLD,
+    INPUT_MIDDLE + RESET_DELTA_THRESHOLD,
+};
+static constexpr Tiny::Pair<u16, u16> NON_CONFLICT_RANGE = {
+    INPUT_MIDDLE - NON_CONFLICT_DELTA_THRESHOLD,
+    INPUT_MIDDLE + NON_CONFLICT_DELTA_THRESHOLD,
+};
+
+static_assert(JoystickController::BUTTON_PIN == 2, "The button must be on INT0 (pin 2, PD2)");
+
+/* Constexpr functions */
+static constexpr u32 msToUs(const u32 ms) { return ms * 1000; }
+
+/*
+ *  Button edges, from the INT0 interrupt (single producer) to `getButtonValue` (single
+ *  consumer). When the queue is full (only bounces can fill it), the edge is dropped and
+ *  `edgesDropped` tells the consumer to read the level of the pin once it has caught up.
+ */
+struct Edge {
+    u32 us;
+    bool value;
+};
+static constexpr u8 EDGE_QUEUE_SIZE = 8;
+static BOARD_LOCAL Tiny::SpscQueue<Edge, EDGE_QUEUE_SIZE> edges;
+static BOARD_LOCAL volatile bool edgesDropped = false;
+
+ISR(INT0_vect)
+{
+    if (!edges.push({ micros(), bool(bit_is_set(PIND, PIND2)) }))
+        edgesDropped = true;
+}
 
 void JoystickController::init()
 {
     pinMode(BUTTON_PIN, INPUT_PULLUP);
     button.previousValue = HIGH;
-    button.previousTs = millis();
+    button.longReported = false;
+    button.previousUs = micros();
+    button.lastTapUs = button.previousUs - msToUs(DOUBLE_TAP_WINDOW);
+
+    /* Interrupt on both edges */
+    EICRA = u8((EICRA & ~_BV(ISC01)) | _BV(ISC00));
+    EIFR = _BV(INTF0);
+    EIMSK |= _BV(INT0);
+    stick.dir = Direction::None;
+    stick.repeat = false;
+    moveState = MoveState::Ok;
 }
 
-JoystickController::Press JoystickController::getButtonValue(const u32 currentTs)
+JoystickController::Press JoystickController::getButtonValue(const u32 currentUs)
 {
-    /* Button thresholds */
-    static constexpr u32 SHORT_PRESS_DUR = 50;
-    static constexpr u32 LONG_PRESS_DURATION = 1000;
+    /*
+     *  Edges are classified by the times the interrupt took them at, however late they are
+     *  consumed. One call reports at most one press, the edges after it wait for the next.
+     */
+    Edge edge;
+    while (edges.pop(edge)) {
+        const auto press = applyEdge(edge.us, edge.value);
+        if (press != Press::None)
+            return press;
+    }
 
-    const bool changed = updateButton(currentTs);
-    if (!changed || !button.previousValue || button.pressDur < SHORT_PRESS_DUR)
-        return Press::None;
-    return Press(u8(Press::Short) + (button.pressDur > LONG_PRESS_DURATION));
+    if (edgesDropped) {
+        edgesDropped = false;
+        const auto press = applyEdge(currentUs, digitalRead(BUTTON_PIN));
+        if (press != Press::None)
+            return press;
+    }
+
+    /* A long press is reported as soon as the button has been held for `LONG_PRESS_DUR` */
+    if (!button.previousValue && !button.longReported
+        && currentUs - button.previousUs > msToUs(LONG_PRESS_DUR)) {
+        button.longReported = true;
+        return Press::Long;
+    }
+
+    return Press::None;
 }
 
-JoystickController::Direction JoystickController::getDirection()
+void JoystickController::ignoreCurrentPress(const u32 currentUs)
 {
-    /* Axis thresholds */
-    static constexpr Tiny::Pair<u16, u16> INPUT_RANGE = {
-        0,
-        1023,
-    };
-    static constexpr u16 INPUT_MIDDLE = INPUT_RANGE.second / 2;
-    static constexpr u16 AXIS_DELTA_THRESHOLD = 400;
-    static constexpr u16 RESET_DELTA_THRESHOLD = 80;
-    static constexpr u16 NON_CONFLICT_DELTA_THRESHOLD = 200;
-    static constexpr u16 AXIS_MIN_THRESHOLD = INPUT_MIDDLE - AXIS_DELTA_THRESHOLD;
-    static constexpr u16 AXIS_MAX_THRESHOLD = INPUT_MIDDLE + AXIS_DELTA_THRESHOLD;
-    static constexpr Tiny::Pair<u16, u16> RESET_RANGE = {
-        INPUT_MIDDLE - RESET_DELTA_THRESHOLD,
-        INPUT_MIDDLE + RESET_DELTA_THRESHOLD,
-    };
-    static constexpr Tiny::Pair<u16, u16> NON_CONFLICT_RANGE = {
-        INPUT_MIDDLE - NON_CONFLICT_DELTA_THRESHOLD,
-        INPUT_MIDDLE + NON_CONFLICT_DELTA_THRESHOLD,
-    };
+    /*
+     *  Drop the edges seen so far and pretend the button went down now and was already
+     *  reported as a long press. If it is up already, there is nothing left to ignore.
+     */
+    edges.clear();
+    button.previousValue = digitalRead(BUTTON_PIN);
+    button.longReported = true;
+    button.previousUs = currentUs;
+}
 
+JoystickController::Direction JoystickController::getDirection(const u32 currentTs)
+{
     const auto xVal = u16(analogRead(X_AXIS_PIN));
     const auto yVal = u16(analogRead(Y_AXIS_PIN));
+    const auto dir = readDirection(xVal, yVal);
+
+    stick.repeat = false;
 
     /*
-     *  Only return a direction if an axis is past the minimum/maximum threshold and the other
-     *  axis is in the non-conflict range. This avoids processing a direction for both axes at
-     *  the same time.
-     *
-     *  The `MoveState::NeedsReset` begins after a move and ends when both axes
-     *  are in the `RESET_RANGE`.
+     *  The `MoveState::NeedsReset` begins after a move and ends when both axes are in the
+     *  `RESET_RANGE`. While it lasts, holding the same direction repeats it: first after
+     *  `REPEAT_DELAY`, then every `REPEAT_INTERVAL`, shrinking by `REPEAT_ACCELERATION` with
+     *  each repeat down to `REPEAT_MIN_INTERVAL`.
      */
     switch (moveState) {
-    case MoveState::Ok: {
-        Direction xDir;
-        if constexpr (INVERTED_X)
-            xDir = xVal < AXIS_MIN_THRESHOLD
-                ? Direction::Right
-                : (xVal > AXIS_MAX_THRESHOLD ? Direction::Left : Direction::None);
-        else
-            xDir = xVal < AXIS_MIN_THRESHOLD
-                ? Direction::Left
-                : (xVal > AXIS_MAX_THRESHOLD ? Direction::Right : Direction::None);
-
-        Direction yDir;
-        if constexpr (INVERTED_Y)
-            yDir = yVal < AXIS_MIN_THRESHOLD
-                ? Direction::Up
-                : (yVal > AXIS_MAX_THRESHOLD ? Direction::Down : Direction::None);
-        else
-            yDir = yVal < AXIS_MIN_THRESHOLD
-                ? Direction::Down
-                : (yVal > AXIS_MAX_THRESHOLD ? Direction::Up : Direction::None);
+    case MoveState::Ok:
+        if (dir == Direction::None)
+            return Direction::None;
 
         moveState = MoveState::NeedsReset;
-        if (u8(xDir) && yVal == Tiny::clamp(yVal, NON_CONFLICT_RANGE))
-            return xDir;
-        if (u8(yDir) && xVal == Tiny::clamp(xVal, NON_CONFLICT_RANGE))
-            return yDir;
-
-        moveState = MoveState::Ok;
-        return Direction::None;
-    }
+        stick.dir = dir;
+        stick.previousTs = currentTs;
+        stick.wait = REPEAT_DELAY;
+        return dir;
     case MoveState::NeedsReset:
-        if (xVal == Tiny::clamp(xVal, RESET_RANGE) && yVal == Tiny::clamp(yVal, RESET_RANGE))
+        if (xVal == Tiny::clamp(xVal, RESET_RANGE) && yVal == Tiny::clamp(yVal, RESET_RANGE)) {
             moveState = MoveState::Ok;
-        return Direction::None;
+            return Direction::None;
+        }
+
+        if (dir != stick.dir) {
+            stick.previousTs = currentTs;
+            stick.wait = REPEAT_DELAY;
+            return Direction::None;
+        }
+
+        if (currentTs - stick.previousTs < stick.wait)
+            return Direction::None;
+
+        stick.repeat = true;
+        stick.previousTs = currentTs;
+        stick.wait = stick.wait > REPEAT_INTERVAL
+            ? REPEAT_INTERVAL
+            : (stick.wait > REPEAT_MIN_INTERVAL + REPEAT_ACCELERATION
+                    ? stick.wait - REPEAT_ACCELERATION
+                    : REPEAT_MIN_INTERVAL);
+        return dir;
     default:
         UNREACHABLE;
     }
 }
 
-bool JoystickController::updateButton(const u32 currentTs)
+JoystickController::Direction JoystickController::readDirection(
+    const u16 xVal, const u16 yVal) const
 {
-    const bool currentValue = digitalRead(BUTTON_PIN);
-    if (currentValue != button.previousValue) {
-        button.previousValue = currentValue;
-        button.pressDur = currentTs - button.previousTs;
-        button.previousTs = currentTs;
+    /*
+     *  Only return a direction if an axis is past the minimum/maximum threshold and the other
+     *  axis is in the non-conflict range. This avoids processing a direction for both axes at
+     *  the same time.
+     */
+    Direction xDir;
+    if constexpr (INVERTED_X)
+        xDir = xVal < AXIS_MIN_THRESHOLD
+            ? Direction::Right
+            : (xVal > AXIS_MAX_THRESHOLD ? Direction::Left : Direction::None);
+    else
+        xDir = xVal < AXIS_MIN_THRESHOLD
+            ? Direction::Left
+            : (xVal > AXIS_MAX_THRESHOLD ? Direction::Right : Direction::None);
+
+    Direction yDir;
+    if constexpr (INVERTED_Y)
+        yDir = yVal < AXIS_MIN_THRESHOLD
+            ? Direction::Up
+            : (yVal > AXIS_MAX_THRESHOLD ? Direction::Down : Direction::None);
+    else
+        yDir = yVal < AXIS_MIN_THRESHOLD
+            ? Direction::Down
+            : (yVal > AXIS_MAX_THRESHOLD ? Direction::Up : Direction::None);
+
+    if (u8(xDir) && yVal == Tiny::clamp(yVal, NON_CONFLICT_RANGE))
+        return xDir;
+    if (u8(yDir) && xVal == Tiny::clamp(xVal, NON_CONFLICT_RANGE))
+        return yDir;
+
+    return Direction::None;
+}
+
+JoystickController::Press JoystickController::applyEdge(const u32 us, const bool value)
+{
+    /*
+     *  Presses shorter than `SHORT_PRESS_DUR` are bounces. Other presses are reported on
+     *  release (the one after a long press is ignored), and a short press released within
+     *  `DOUBLE_TAP_WINDOW` of the previous one is reported as `Double` (the first one still
+     *  comes through as `Short`). A press that was over before its end was consumed can still
+     *  be long.
+     */
+    if (value == button.previousValue)
+        return Press::None;
+
+    const u32 pressDur = us - button.previousUs;
+    button.previousValue = value;
+    button.previousUs = us;
+
+    if (!value) {
+        button.longReported = false;
+        return Press::None;
+    }
+
+    if (button.longReported || pressDur < msToUs(SHORT_PRESS_DUR))
+        return Press::None;
+
+    if (pressDur > msToUs(LONG_PRESS_DUR)) {
+        button.longReported = true;
+        return Press::Long;
+    }
 
-        return true;
+    if (us - button.lastTapUs < msToUs(DOUBLE_TAP_WINDOW)) {
+        button.lastTapUs = us - msToUs(DOUBLE_TAP_WINDOW);
+        return Press::Double;
     }
 
-    return false;
+    button.lastTapUs = us;
+    return Press::Short;
 }
@@ -16,6 +16,7 @@ public:
         None = 0,
         Short,
         Long,
+        Double,
     };
     enum class MoveState : u8 {
         Ok = 0,
@@ -23,9 +24,13 @@ public:
     };
 
     void init();
+    /* The button takes timestamps in microseconds, the stick in milliseconds */
     Press getButtonValue(u32);
-    Direction getDirection();
+    Direction getDirection(u32);
+    bool isRepeat() const { return stick.repeat; }
+    void ignoreCurrentPress(u32);
 
+    /* INT0: every edge is timestamped by an interrupt */
     static constexpr u8 BUTTON_PIN = 2;
     static constexpr u8 X_AXIS_PIN = A0;
     static constexpr u8 Y_AXIS_PIN = A1;
@@ -33,14 +38,31 @@ public:
     static constexpr bool INVERTED_Y = true;
     static constexpr auto NUM_DIRECTIONS = u8(Direction::NumDirections);
 
+    /* Gesture thresholds (ms) */
+    static constexpr u32 SHORT_PRESS_DUR = 50;
+    static constexpr u32 LONG_PRESS_DUR = 1000;
+    static constexpr u32 DOUBLE_TAP_WINDOW = 300;
+    static constexpr u32 REPEAT_DELAY = 400;
+    static constexpr u32 REPEAT_INTERVAL = 160;
+    static constexpr u32 REPEAT_MIN_INTERVAL = 40;
+    static constexpr u32 REPEAT_ACCELERATION = 20;
+
 private:
-    bool updateButton(u32);
+    Press applyEdge(u32, bool);
+    Direction readDirection(u16, u16) const;
 
 private:
     struct {
         bool previousValue;
-        u32 previousTs;
-        u32 pressDur;
+        bool longReported;
+        u32 previousUs;
+        u32 lastTapUs;
     } button;
+    struct {
+        Direction dir;
+        bool repeat;
+        u32 previousTs;
+        u32 wait;
+    } stick;
     MoveState moveState;
 };
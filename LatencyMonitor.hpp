@@ -0,0 +1,100 @@
+#pragma once
+#include "utils.hpp"
+
+/*
+ *  Input-to-photon latency: the time between sampling an input event and the end of the first
+ *  display write that follows it. Samples are kept as log2 histograms, one for each state
+ *  (identified by `Key`) that was active when the input was sampled.
+ */
+struct LatencyHistogram {
+public:
+    void add(const u32 us)
+    {
+        u8 bucket = 0;
+        for (u32 v = us >> FIRST_BUCKET_SHIFT; v && bucket < NUM_BUCKETS - 1; v >>= 1)
+            ++bucket;
+
+        if (counts[bucket] != SATURATED)
+            ++counts[bucket];
+        if (total != SATURATED)
+            ++total;
+        if (us > maxUs)
+            maxUs = us;
+    }
+
+    /* The `pct`-th percentile (us): its bucket's upper bound, at most the largest sample */
+    u32 percentile(const u8 pct) const
+    {
+        if (!total)
+            return 0;
+
+        const u32 target = (u32(total) * pct + 99) / 100;
+        u32 seen = 0;
+        for (u8 i = 0; i < NUM_BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= target)
+                return i == NUM_BUCKETS - 1 ? maxUs : min(bucketLimit(i), maxUs);
+        }
+
+        return maxUs;
+    }
+
+    static constexpr u32 bucketLimit(const u8 bucket)
+    {
+        return u32(1) << (FIRST_BUCKET_SHIFT + bucket);
+    }
+
+    /* Bucket `i` holds latencies below `bucketLimit(i)`, the last one everything above */
+    static constexpr u8 NUM_BUCKETS = 8;
+    static constexpr u8 FIRST_BUCKET_SHIFT = 7;
+    static constexpr u16 SATURATED = 0xFFFF;
+
+public:
+    u16 counts[NUM_BUCKETS];
+    u16 total;
+    u32 maxUs;
+};
+
+template <typename Key, u8 NUM_SLOTS> struct LatencyMonitor {
+public:
+    struct Slot {
+        Key key;
+        LatencyHistogram histogram;
+    };
+
+    /* A newer event replaces an older one that never caused a display write */
+    void onInput(const Key key, const u32 sampleUs)
+    {
+        pendingKey = key;
+        pendingUs = sampleUs;
+        pending = true;
+    }
+
+    void onDisplayWrite(const u32 nowUs)
+    {
+        if (!pending)
+            return;
+        pending = false;
+
+        const u32 latency = nowUs - pendingUs;
+        if (latency > TIMEOUT_US)
+            return;
+
+        for (auto& slot : slots) {
+            if (slot.key == pendingKey || slot.key == Key {}) {
+                slot.key = pendingKey;
+                slot.histogram.add(latency);
+                return;
+            }
+        }
+    }
+
+    /* Writes that happen this long after an input are not considered a response to it */
+    static constexpr u32 TIMEOUT_US = 250000;
+
+public:
+    Tiny::Array<Slot, NUM_SLOTS> slots;
+    Key pendingKey;
+    u32 pendingUs;
+    bool pending;
+};
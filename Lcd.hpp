@@ -0,0 +1,24 @@
+#pragma once
+#include "LcdI2c.hpp"
+#include "LcdParallel.hpp"
+#include "utils.hpp"
+
+/*
+ *  The LCD backend, selected at compile time with LCD_BACKEND (see the Makefile). Both drivers
+ *  have the same interface and count the bytes they put on their bus, like the matrix's
+ *  MatrixBus (see BusTraffic.hpp).
+ */
+#define LCD_BACKEND_PARALLEL 0
+#define LCD_BACKEND_I2C 1
+
+#ifndef LCD_BACKEND
+#define LCD_BACKEND LCD_BACKEND_PARALLEL
+#endif
+
+/* The driver for an LCD on RS, EN and D4..D7; behind the backpack, the pins are unused */
+#if LCD_BACKEND == LCD_BACKEND_I2C
+template <u8 RS, u8 EN, u8 D4, u8 D5, u8 D6, u8 D7> using LcdDriver = LcdI2c;
+#else
+template <u8 RS, u8 EN, u8 D4, u8 D5, u8 D6, u8 D7>
+using LcdDriver = LcdParallel<RS, EN, D4, D5, D6, D7>;
+#endif
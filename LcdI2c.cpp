@@ -0,0 +1,226 @@
+#include "LcdI2c.hpp"
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <util/twi.h>
+
+/*
+ *  Single producer (the main loop) and single consumer (the TWI interrupt) for the queue. The
+ *  interrupt keeps the bus while there is something to send and releases it once the queue is
+ *  empty; `busy` tells the main loop whether it has to start a new write. The main loop waits
+ *  on TWCR itself: TWIE is set from the start condition to the stop one.
+ */
+struct Transfer {
+    u8 value;
+    u8 mode;
+};
+
+/* Expander outputs besides D4..D7 (RW stays low: the display is only written) */
+static constexpr u8 RS = _BV(0);
+static constexpr u8 EN = _BV(2);
+static constexpr u8 BACKLIGHT = _BV(3);
+
+/* Mode of the transfers that only strobe the high nibble in, to enter 4-bit mode */
+static constexpr u8 HIGH_NIBBLE_ONLY = _BV(7);
+
+/* The HD44780 is ready 40 ms after power on */
+static constexpr u32 POWER_ON_MS = 40;
+static constexpr u16 CLEAR_US = 1520;
+
+/* The waits after each step of the initialization, from when its transfers are out */
+static constexpr u16 INIT_WAITS_US[] = { 4100, 100, 100, CLEAR_US, 0 };
+static constexpr u8 INIT_DONE = u8(sizeof(INIT_WAITS_US) / sizeof(INIT_WAITS_US[0]));
+
+/* Function declarations */
+static void enqueue(Transfer);
+static void start();
+static u8 expanderByte(const Transfer&, u8 phase);
+
+static BOARD_LOCAL Tiny::SpscQueue<Transfer, LcdI2c::QUEUE_SIZE> queue;
+static BOARD_LOCAL u8 slaveAddress;
+static BOARD_LOCAL u8 phase = 0;
+static BOARD_LOCAL volatile u8 backlight = BACKLIGHT;
+static BOARD_LOCAL volatile bool busy = false;
+
+ISR(TWI_vect)
+{
+    switch (TW_STATUS) {
+    case TW_START:
+    case TW_REP_START:
+        TWDR = slaveAddress;
+        TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWIE);
+        return;
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+        if (!queue.empty()) {
+            const auto& transfer = queue.front();
+            TWDR = expanderByte(transfer, phase);
+            TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWIE);
+
+            if (++phase == (transfer.mode & HIGH_NIBBLE_ONLY ? 2 : 4)) {
+                phase = 0;
+                queue.drop();
+            }
+            return;
+        }
+        break;
+    default:
+        /* No backpack answers, or the bus was lost: what is queued would fail the same way */
+        phase = 0;
+        while (!queue.empty())
+            queue.drop();
+        break;
+    }
+
+    TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+    busy = false;
+}
+
+size_t LcdI2c::write(const u8 value)
+{
+    send(value, RS);
+    return 1;
+}
+
+void LcdI2c::beginTwoLines()
+{
+    slaveAddress = u8(address << 1 | TW_WRITE);
+
+    /* The internal pull-ups, for backpacks without their own */
+    pinMode(SDA, INPUT_PULLUP);
+    pinMode(SCL, INPUT_PULLUP);
+    TWSR = 0;
+    TWBR = u8((F_CPU / SCL_FREQ - 16) / 2);
+    TWCR = _BV(TWEN);
+}
+
+/* The datasheet's initialization by instruction, whatever state the display is in */
+bool LcdI2c::poll()
+{
+    if (initStep == INIT_DONE)
+        return true;
+    if (millis() < POWER_ON_MS || busy)
+        return false;
+
+    /* The step's wait starts once the interrupt has sent it, at the latest when seen so */
+    if (initStep > 0) {
+        if (!stepSent) {
+            stepUs = micros();
+            stepSent = true;
+        }
+        if (micros() - stepUs < INIT_WAITS_US[initStep - 1])
+            return false;
+    }
+
+    switch (initStep) {
+    case 0:
+    case 1:
+    case 2:
+        send(0x30, HIGH_NIBBLE_ONLY);
+        break;
+    case 3:
+        send(0x20, HIGH_NIBBLE_ONLY);
+        command(LCD_FUNCTIONSET | LCD_4BITMODE | LCD_2LINE | LCD_5x8DOTS);
+        setDisplayControl(LCD_DISPLAYON);
+        command(LCD_CLEARDISPLAY);
+        break;
+    default:
+        command(LCD_ENTRYMODESET | LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT);
+        break;
+    }
+    stepSent = false;
+    return ++initStep == INIT_DONE;
+}
+
+void LcdI2c::clear()
+{
+    command(LCD_CLEARDISPLAY);
+    flush();
+    delayMicroseconds(CLEAR_US);
+}
+
+void LcdI2c::setCursor(const u8 col, const u8 row)
+{
+    command(u8(LCD_SETDDRAMADDR | (row * ROW_OFFSET + col)));
+}
+
+void LcdI2c::blink()
+{
+    setDisplayControl(displayControl | LCD_BLINKON);
+}
+
+void LcdI2c::noBlink()
+{
+    setDisplayControl(displayControl & u8(~LCD_BLINKON));
+}
+
+/* The backlight follows the display, it is the only way to dim it through the backpack */
+void LcdI2c::display()
+{
+    backlight = BACKLIGHT;
+    setDisplayControl(displayControl | LCD_DISPLAYON);
+}
+
+void LcdI2c::noDisplay()
+{
+    backlight = 0;
+    setDisplayControl(displayControl & u8(~LCD_DISPLAYON));
+}
+
+void LcdI2c::createChar(const u8 location, u8* const charmap)
+{
+    command(u8(LCD_SETCGRAMADDR | (location & 0x7) << 3));
+    for (u8 i = 0; i < 8; ++i)
+        write(charmap[i]);
+}
+
+void LcdI2c::flush()
+{
+    while (TWCR & _BV(TWIE)) { }
+}
+
+void LcdI2c::command(const u8 value)
+{
+    send(value, 0);
+}
+
+void LcdI2c::send(const u8 value, const u8 mode)
+{
+    bytes = u16(bytes + (mode & HIGH_NIBBLE_ONLY ? BUS_BYTES / 2 : BUS_BYTES));
+    enqueue({ value, mode });
+}
+
+void LcdI2c::setDisplayControl(const u8 flags)
+{
+    displayControl = flags;
+    command(u8(LCD_DISPLAYCONTROL | flags));
+}
+
+void enqueue(const Transfer transfer)
+{
+    /* The interrupt sends a transfer every ~0.4 ms, so a full queue does not last */
+    while (!queue.space() && TWCR & _BV(TWIE)) { }
+    queue.push(transfer);
+
+    /* Atomic with the interrupt's last look at the queue, which would miss this transfer */
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (!busy) {
+            busy = true;
+            start();
+        }
+    }
+}
+
+void start()
+{
+    /* A stop condition may still be on its way out */
+    while (TWCR & _BV(TWSTO)) { }
+    TWCR = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN) | _BV(TWIE);
+}
+
+/* The expander outputs for step `phase` of a transfer: each nibble with EN high, then low */
+u8 expanderByte(const Transfer& transfer, const u8 phase)
+{
+    const u8 nibble = phase < 2 ? transfer.value & 0xF0 : u8(transfer.value << 4);
+    return u8(nibble | (transfer.mode & RS) | backlight | (phase % 2 ? 0 : EN));
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "LiquidCrystal.h"
+#include "utils.hpp"
+
+/*
+ *  HD44780 behind a PCF8574 I2C backpack, with the interface of `LcdParallel` (see
+ *  `LcdDriver` in Lcd.hpp). The expander's outputs are RS, RW, EN, the backlight
+ *  and D4..D7.
+ *
+ *  Every LCD byte becomes the 4 expander writes that strobe its two nibbles in, and the TWI
+ *  interrupt streams the queued ones back to back in a single I2C write: the bytes after the
+ *  first cost no start condition nor address. One I2C byte takes longer than the HD44780
+ *  needs to execute a character, so nothing waits between them; only `clear` waits for the
+ *  display, which takes 1.52 ms to execute it.
+ *
+ *  The constructor touches no hardware: `beginTwoLines` sets the bus up and `poll` initializes
+ *  the display, with interrupts enabled, a step per call once the previous one's transfers are
+ *  out and its wait is over. The display must not be written before `poll` is true. This owns
+ *  TWI_vect, so the sketch must not use `Wire`.
+ */
+class LcdI2c : public Print {
+public:
+    explicit LcdI2c(const u8 address)
+        : address(address)
+    {
+    }
+
+    size_t write(u8 value) override;
+    using Print::write;
+
+    void beginTwoLines();
+    bool poll();
+    void clear();
+    void setCursor(u8 col, u8 row);
+    void blink();
+    void noBlink();
+    void display();
+    void noDisplay();
+    void createChar(u8 location, u8* charmap);
+    void flush();
+
+    /* I2C data bytes per LCD byte: a nibble is written with EN high, then low */
+    static constexpr u8 BUS_BYTES = 4;
+    /* DDRAM address of the second row */
+    static constexpr u8 ROW_OFFSET = 0x40;
+    static constexpr u32 SCL_FREQ = 100000;
+    static constexpr u8 QUEUE_SIZE = 32;
+
+private:
+    void command(u8 value);
+    void send(u8 value, u8 mode);
+    void setDisplayControl(u8 flags);
+
+private:
+    u8 address;
+    u8 displayControl = 0;
+    u8 initStep = 0;
+    /* Whether `stepUs` is when the last step's transfers were seen out */
+    bool stepSent = false;
+    u32 stepUs = 0;
+
+public:
+    u16 bytes = 0;
+};
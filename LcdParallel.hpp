@@ -0,0 +1,155 @@
+#pragma once
+#include "FastPin.hpp"
+#include "LiquidCrystal.h"
+#include "utils.hpp"
+#include <util/delay.h>
+
+/*
+ *  HD44780 on its own pins in 4-bit mode, with the interface of `LcdI2c` (see `LcdDriver`
+ *  in Lcd.hpp), in place of LiquidCrystal and its `digitalWrite` calls. The pins are
+ *  resolved at compile time: RS and EN take one instruction each and, when D4..D7 are
+ *  consecutive bits of one port (A2..A5 are PC2..PC5), a nibble is a single masked store.
+ *
+ *  The waits are the datasheet's minimums: enable pulses of a few cycles and the 37 us a
+ *  command executes in, where LiquidCrystal waits 100 us after every nibble (see
+ *  tests/lcd_test.cpp). RW is tied low, so the busy flag cannot be read instead.
+ *
+ *  Like LcdI2c, the constructor touches no hardware: `beginTwoLines` sets the pins up and
+ *  `poll` initializes the display, a step per call once the previous one's wait is over, so
+ *  that no frame waits for it. The display must not be written before `poll` is true.
+ */
+template <u8 RS, u8 EN, u8 D4, u8 D5, u8 D6, u8 D7> class LcdParallel : public Print {
+public:
+    size_t write(const u8 value) override
+    {
+        send(value, true);
+        return 1;
+    }
+    using Print::write;
+
+    void beginTwoLines()
+    {
+        FastPin<RS>::output();
+        FastPin<EN>::output();
+        FastPin<D4>::output();
+        FastPin<D5>::output();
+        FastPin<D6>::output();
+        FastPin<D7>::output();
+        FastPin<RS>::low();
+        FastPin<EN>::low();
+    }
+    /* The datasheet's initialization by instruction, whatever state the display is in */
+    bool poll()
+    {
+        if (initStep == INIT_DONE)
+            return true;
+        if (millis() < POWER_ON_MS || micros() - stepUs < stepWaitUs)
+            return false;
+
+        switch (initStep) {
+        case 0:
+        case 1:
+        case 2:
+            writeNibble(0x3);
+            stepWaitUs = initStep == 0 ? 4100 : 100;
+            break;
+        case 3:
+            writeNibble(0x2);
+            delayMicroseconds(EXECUTION_US);
+            command(LCD_FUNCTIONSET | LCD_4BITMODE | LCD_2LINE | LCD_5x8DOTS);
+            setDisplayControl(LCD_DISPLAYON);
+            command(LCD_CLEARDISPLAY);
+            stepWaitUs = CLEAR_US - EXECUTION_US;
+            break;
+        default:
+            command(LCD_ENTRYMODESET | LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT);
+            break;
+        }
+        stepUs = micros();
+        return ++initStep == INIT_DONE;
+    }
+    void clear()
+    {
+        command(LCD_CLEARDISPLAY);
+        delayMicroseconds(CLEAR_US - EXECUTION_US);
+    }
+    void setCursor(const u8 col, const u8 row)
+    {
+        command(u8(LCD_SETDDRAMADDR | (row * ROW_OFFSET + col)));
+    }
+    void blink() { setDisplayControl(displayControl | LCD_BLINKON); }
+    void noBlink() { setDisplayControl(displayControl & u8(~LCD_BLINKON)); }
+    void display() { setDisplayControl(displayControl | LCD_DISPLAYON); }
+    void noDisplay() { setDisplayControl(displayControl & u8(~LCD_DISPLAYON)); }
+    void createChar(const u8 location, u8* const charmap)
+    {
+        command(u8(LCD_SETCGRAMADDR | (location & 0x7) << 3));
+        for (u8 i = 0; i < 8; ++i)
+            write(charmap[i]);
+    }
+    /* Every write returns once the display has executed it */
+    void flush() { }
+
+    static constexpr u8 BUS_BYTES = 1;
+    /* DDRAM address of the second row */
+    static constexpr u8 ROW_OFFSET = 0x40;
+
+private:
+    void command(const u8 value) { send(value, false); }
+    void send(const u8 value, const bool data)
+    {
+        ++bytes;
+        FastPin<RS>::write(data);
+        writeNibble(u8(value >> 4));
+        writeNibble(value & 0xF);
+        delayMicroseconds(EXECUTION_US);
+    }
+    void setDisplayControl(const u8 flags)
+    {
+        displayControl = flags;
+        command(u8(LCD_DISPLAYCONTROL | flags));
+    }
+
+    /* No interrupt writes to the data pins' port, which the masked store reads back */
+    static void writeNibble(const u8 nibble)
+    {
+        if (DATA_ON_ONE_PORT) {
+            auto& port = FastPin<D4>::port();
+            port = u8((port & u8(~DATA_MASK)) | nibble << FastPin<D4>::BIT);
+        } else {
+            FastPin<D4>::write(nibble & 0x1);
+            FastPin<D5>::write(nibble & 0x2);
+            FastPin<D6>::write(nibble & 0x4);
+            FastPin<D7>::write(nibble & 0x8);
+        }
+
+        /* The data is set up long before EN rises (80 ns) and EN stays high 230 ns at least */
+        FastPin<EN>::high();
+        _delay_us(ENABLE_PULSE_US);
+        FastPin<EN>::low();
+        _delay_us(ENABLE_PULSE_US);
+    }
+
+    static constexpr bool DATA_ON_ONE_PORT = FastPin<D5>::PORT_IDX == FastPin<D4>::PORT_IDX
+        && FastPin<D6>::PORT_IDX == FastPin<D4>::PORT_IDX
+        && FastPin<D7>::PORT_IDX == FastPin<D4>::PORT_IDX
+        && FastPin<D5>::BIT == FastPin<D4>::BIT + 1 && FastPin<D6>::BIT == FastPin<D4>::BIT + 2
+        && FastPin<D7>::BIT == FastPin<D4>::BIT + 3;
+    static constexpr u8 DATA_MASK = u8(0xF << FastPin<D4>::BIT);
+
+    /* The HD44780 is ready 40 ms after power on */
+    static constexpr u32 POWER_ON_MS = 40;
+    static constexpr u16 EXECUTION_US = 37;
+    static constexpr u16 CLEAR_US = 1520;
+    static constexpr double ENABLE_PULSE_US = 0.25;
+    static constexpr u8 INIT_DONE = 5;
+
+private:
+    u8 displayControl = 0;
+    u8 initStep = 0;
+    u16 stepWaitUs = 0;
+    u32 stepUs = 0;
+
+public:
+    u16 bytes = 0;
+};
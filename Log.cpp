@@ -0,0 +1,90 @@
+#include "Log.hpp"
+
+#if LOG_LEVEL < LOG_LEVEL_NONE
+#include <avr/interrupt.h>
+
+/*
+ *  Single producer (the main loop) and single consumer (the UDRE interrupt). Records are
+ *  written ahead of the queue and only published by `commit`, so the interrupt never sends
+ *  half of a record.
+ *
+ *  This owns USART_UDRE_vect, so the sketch must not use `Serial`.
+ */
+static BOARD_LOCAL Tiny::SpscQueue<u8, Log::TX_BUFFER_SIZE> tx;
+static BOARD_LOCAL u8 txStaged = 0;
+static BOARD_LOCAL u16 numDropped = 0;
+
+void Log::init()
+{
+    static constexpr u16 UBRR_VALUE = u16((F_CPU + 4 * BAUD_RATE) / (8 * BAUD_RATE) - 1);
+
+    UBRR0 = UBRR_VALUE;
+    UCSR0A = _BV(U2X0);
+    UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);
+    UCSR0B = _BV(TXEN0);
+
+    write<LogId::Boot>();
+}
+
+void Log::flush()
+{
+    /* Wait for the ring to empty, then for the last two bytes to leave the USART */
+    static constexpr u16 DRAIN_US = u16(2 * 10 * 1000000 / BAUD_RATE + 1);
+
+    while (!tx.empty()) { }
+    delayMicroseconds(DRAIN_US);
+}
+
+bool Log::reserve(const u8 size)
+{
+    static constexpr u8 DROPPED_SIZE = RECORD_HEADER_SIZE + sizeof(numDropped);
+
+    const u8 free = u8(tx.space() - txStaged);
+    const u8 needed = u8(size + (numDropped ? DROPPED_SIZE : 0));
+    if (needed > free) {
+        if (numDropped != 0xFFFF)
+            ++numDropped;
+        return false;
+    }
+
+    if (numDropped) {
+        const u8 id = u8(LogId::Dropped);
+        const u32 ts = micros();
+        put(&id, sizeof(id));
+        put(&ts, sizeof(ts));
+        put(&numDropped, sizeof(numDropped));
+        numDropped = 0;
+    }
+
+    return true;
+}
+
+void Log::put(const void* data, const u8 size)
+{
+    auto bytes = (const u8*)data;
+    for (u8 i = 0; i < size; ++i)
+        tx.ahead(txStaged++) = bytes[i];
+}
+
+void Log::commit()
+{
+    tx.publish(txStaged);
+    txStaged = 0;
+    UCSR0B |= _BV(UDRIE0);
+}
+
+ISR(USART_UDRE_vect)
+{
+    u8 byte;
+    if (!tx.pop(byte)) {
+        UCSR0B &= u8(~_BV(UDRIE0));
+        return;
+    }
+
+    UDR0 = byte;
+}
+#else
+void Log::init() { }
+
+void Log::flush() { }
+#endif
@@ -0,0 +1,118 @@
+/*
+ *  Deferred-format binary logging.
+ *
+ *  A record is the event id, a 32-bit microsecond timestamp and the raw bytes of the
+ *  arguments. Records are queued in a ring buffer that the USART data-register-empty
+ *  interrupt drains, so `Log::write` never waits for the UART. A record that doesn't fit is
+ *  dropped whole and accounted for in a later `Dropped` record. Events below `LOG_LEVEL`
+ *  compile to nothing.
+ */
+
+#pragma once
+#include "utils.hpp"
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARN 3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_NONE 5
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+enum class LogLevel : u8 {
+    Trace = LOG_LEVEL_TRACE,
+    Debug = LOG_LEVEL_DEBUG,
+    Info = LOG_LEVEL_INFO,
+    Warn = LOG_LEVEL_WARN,
+    Error = LOG_LEVEL_ERROR,
+};
+
+enum class LogId : u8 {
+#define LOG_EVENT(level, name, fmt) name,
+#include "LogEvents.def"
+#undef LOG_EVENT
+    NumEvents,
+};
+
+namespace LogDetail {
+static constexpr LogLevel LEVELS[] = {
+#define LOG_EVENT(level, name, fmt) LogLevel::level,
+#include "LogEvents.def"
+#undef LOG_EVENT
+};
+
+/* Only used in constant expressions, so the strings never end up in flash */
+static constexpr const char* FORMATS[] = {
+#define LOG_EVENT(level, name, fmt) fmt,
+#include "LogEvents.def"
+#undef LOG_EVENT
+};
+
+/* Argument bytes of a format string, written as recursive C++11 constexpr functions */
+constexpr u8 placeholderSize(const char* t)
+{
+    return t[0] == 'f' && t[1] == 'n'
+        ? 2
+        : (t[0] == 'u' || t[0] == 'i' ? (t[1] == '8' ? 1 : (t[1] == '1' ? 2 : 4)) : 0);
+}
+
+constexpr u8 formatSize(const char* fmt)
+{
+    return !fmt[0]
+        ? 0
+        : (fmt[0] == '{' && fmt[1] == '='
+                ? u8(placeholderSize(fmt + 2) + formatSize(fmt + 2))
+                : formatSize(fmt + 1));
+}
+
+template <typename... Ts> struct ArgsSize {
+    static constexpr u8 value = 0;
+};
+
+template <typename T, typename... Ts> struct ArgsSize<T, Ts...> {
+    static constexpr u8 value = u8(sizeof(T) + ArgsSize<Ts...>::value);
+};
+}
+
+struct Log {
+public:
+    static constexpr bool isEnabled(const LogId id)
+    {
+        return u8(LogDetail::LEVELS[u8(id)]) + 1 > LOG_LEVEL;
+    }
+
+    static void init();
+    static void flush();
+
+    template <LogId ID, typename... Ts> static void write(const Ts&... args)
+    {
+        if constexpr (isEnabled(ID)) {
+            static_assert(LogDetail::formatSize(LogDetail::FORMATS[u8(ID)])
+                    == LogDetail::ArgsSize<Ts...>::value,
+                "Log arguments don't match the placeholders of the event's format");
+
+            if (!reserve(u8(RECORD_HEADER_SIZE + LogDetail::ArgsSize<Ts...>::value)))
+                return;
+
+            const u8 id = u8(ID);
+            const u32 ts = micros();
+            put(&id, sizeof(id));
+            put(&ts, sizeof(ts));
+            using Expander = int[];
+            (void)Expander { 0, (put(&args, sizeof(args)), 0)... };
+            commit();
+        }
+    }
+
+    static constexpr u32 BAUD_RATE = 115200;
+    static constexpr u8 TX_BUFFER_SIZE = 64;
+    static constexpr u8 RECORD_HEADER_SIZE = sizeof(LogId) + sizeof(u32);
+
+private:
+    static bool reserve(u8);
+    static void put(const void*, u8);
+    static void commit();
+};
@@ -0,0 +1,64 @@
+#include "MatrixAnimator.hpp"
+
+void MatrixAnimator::play(const Animation& animation, const u32 currentTs)
+{
+    anim = animation;
+    frame = u8(anim.numFrames - 1);
+    backReady = false;
+    frameTs = currentTs - anim.frameMs;
+
+    /* Whatever the matrix showed before is unknown, so the first frame rewrites every row */
+    dirtyRows = 0xFF;
+    memset(buffers[front], 0, NUM_ROWS);
+}
+
+void MatrixAnimator::update(MatrixBus& lc, const u32 currentTs)
+{
+    if (!isPlaying())
+        return;
+
+    if (!backReady) {
+        decodeNext();
+        return;
+    }
+
+    if (currentTs - frameTs < anim.frameMs)
+        return;
+    frameTs = currentTs;
+
+    const auto& shown = buffers[front];
+    const auto& back = buffers[front ^ 1];
+    for (u8 row = 0; row < NUM_ROWS; ++row) {
+        if (back[row] != shown[row] || (dirtyRows & (1 << row)))
+            lc.setRow(0, row, back[row]);
+    }
+
+    dirtyRows = 0;
+    front ^= 1;
+    backReady = false;
+
+    if (frame == anim.numFrames - 1 && !anim.loop)
+        stop();
+}
+
+void MatrixAnimator::decodeNext()
+{
+    auto& back = buffers[front ^ 1];
+
+    /* The first frame is a delta against a blank matrix, the others against the one before */
+    if (++frame == anim.numFrames) {
+        frame = 0;
+        next = anim.data;
+        memset(back, 0, NUM_ROWS);
+    } else {
+        memcpy(back, buffers[front], NUM_ROWS);
+    }
+
+    const u8 changedRows = pgm_read_byte(next++);
+    for (u8 row = 0; row < NUM_ROWS; ++row) {
+        if (changedRows & (1 << row))
+            back[row] ^= pgm_read_byte(next++);
+    }
+
+    backReady = true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "BusTraffic.hpp"
+#include "utils.hpp"
+#include <avr/pgmspace.h>
+
+/*
+ *  Plays frame sequences stored in flash (XOR deltas of row bitmaps, see `tools/animenc.py`)
+ *  at a fixed frame rate without blocking the loop. Every `update` does at most one of two
+ *  small steps: decode the next frame into the back buffer, or, once it is due, send the rows
+ *  that differ from the front buffer (what the matrix shows) and swap the buffers.
+ */
+class MatrixAnimator {
+public:
+    struct Animation {
+        const u8* data;
+        u8 numFrames;
+        u8 frameMs;
+        bool loop;
+    };
+
+    void play(const Animation&, u32);
+    void stop() { anim.data = nullptr; }
+    bool isPlaying() const { return anim.data != nullptr; }
+    void update(MatrixBus&, u32);
+
+    static constexpr u8 NUM_ROWS = 8;
+
+private:
+    void decodeNext();
+
+private:
+    Animation anim;
+    const u8* next;
+    u8 frame;
+    bool backReady;
+    u8 dirtyRows;
+    u8 front;
+    u32 frameTs;
+    u8 buffers[2][NUM_ROWS];
+};
@@ -0,0 +1,113 @@
+#include "MatrixGrayscale.hpp"
+#include "FastPin.hpp"
+#include "GameController.hpp"
+#include <avr/interrupt.h>
+
+using Din = FastPin<GameController::DIN_PIN>;
+using Clk = FastPin<GameController::CLOCK_PIN>;
+using Load = FastPin<GameController::LOAD_PIN>;
+
+/* Written by the main loop, read by the interrupt; a torn row only lasts one plane */
+static BOARD_LOCAL volatile u8 planes[MatrixGrayscale::NUM_BITS][MatrixGrayscale::NUM_ROWS];
+static BOARD_LOCAL u8 currentPlane = 0;
+static BOARD_LOCAL bool active = false;
+
+/* CPU load accounting, in timer ticks */
+static constexpr u32 LOAD_WINDOW_TICKS = 0xFFFF;
+static BOARD_LOCAL u32 busyTicks = 0;
+static BOARD_LOCAL u32 windowTicks = 0;
+static BOARD_LOCAL volatile u16 lastLoadPermille = 0;
+
+static void shiftByte(u8 value)
+{
+    for (u8 i = 0; i < 8; ++i, value = u8(value << 1)) {
+        Din::write(value & 0x80);
+        Clk::high();
+        Clk::low();
+    }
+}
+
+/* The MAX7219 digit registers 1-8 hold the rows */
+static void writeRows(const volatile u8* rows)
+{
+    for (u8 row = 0; row < MatrixGrayscale::NUM_ROWS; ++row) {
+        Load::low();
+        shiftByte(u8(row + 1));
+        shiftByte(rows[row]);
+        Load::high();
+    }
+}
+
+ISR(TIMER1_COMPA_vect)
+{
+    const u8 plane = currentPlane;
+    writeRows(planes[plane]);
+
+    /* CTC cleared TCNT1 on the match, so it now holds the time spent in here */
+    const u16 period = u16(MatrixGrayscale::PLANE_TICKS << plane);
+    OCR1A = period - 1;
+    busyTicks += TCNT1;
+    windowTicks += period;
+    if (windowTicks >= LOAD_WINDOW_TICKS) {
+        lastLoadPermille = u16(busyTicks * 1000 / windowTicks);
+        busyTicks = 0;
+        windowTicks = 0;
+    }
+
+    currentPlane = u8((plane + 1) % MatrixGrayscale::NUM_BITS);
+}
+
+void MatrixGrayscale::begin()
+{
+    for (auto& plane : planes) {
+        for (auto& row : plane)
+            row = 0;
+    }
+
+    Din::output();
+    Clk::output();
+    Load::output();
+    Load::high();
+
+    currentPlane = 0;
+    active = true;
+
+    /* CTC mode on OCR1A, F_CPU / 8 */
+    TCCR1A = 0;
+    TCCR1B = 0;
+    TCNT1 = 0;
+    OCR1A = PLANE_TICKS - 1;
+    TIFR1 = _BV(OCF1A);
+    TIMSK1 = _BV(OCIE1A);
+    TCCR1B = _BV(WGM12) | _BV(CS11);
+}
+
+void MatrixGrayscale::end(MatrixBus& lc)
+{
+    TCCR1B = 0;
+    TIMSK1 = 0;
+    active = false;
+
+    /* Hand back a binary image, which also brings `LedControl`'s copy up to date */
+    for (u8 row = 0; row < NUM_ROWS; ++row) {
+        u8 value = 0;
+        for (const auto& plane : planes)
+            value |= plane[row];
+        lc.setRow(0, row, value);
+    }
+}
+
+bool MatrixGrayscale::isActive() { return active; }
+
+void MatrixGrayscale::set(const u8 row, const u8 col, const u8 level)
+{
+    const u8 mask = u8(0x80 >> col);
+    for (u8 bit = 0; bit < NUM_BITS; ++bit) {
+        if (level & (1 << bit))
+            planes[bit][row] |= mask;
+        else
+            planes[bit][row] &= u8(~mask);
+    }
+}
+
+u16 MatrixGrayscale::cpuLoadPermille() { return lastLoadPermille; }
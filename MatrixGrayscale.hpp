@@ -0,0 +1,28 @@
+#pragma once
+#include "BusTraffic.hpp"
+#include "utils.hpp"
+
+/*
+ *  Per-LED grayscale for the MAX7219 through bit-angle modulation. Every brightness bit has
+ *  its own bit plane; a Timer 1 interrupt sends plane `b` to the matrix and keeps it on for
+ *  `PLANE_TICKS << b`, so a full cycle shows each LED for a time proportional to its level.
+ *
+ *  While active, the interrupt owns the matrix bus: `LedControl` must not be used until `end`.
+ */
+struct MatrixGrayscale {
+public:
+    static void begin();
+    static void end(MatrixBus&);
+    static bool isActive();
+    static void set(u8 row, u8 col, u8 level);
+
+    /* Share of the CPU spent in the interrupt during the previous measuring window */
+    static u16 cpuLoadPermille();
+
+    static constexpr u8 NUM_BITS = 2;
+    static constexpr u8 NUM_LEVELS = 1 << NUM_BITS;
+    static constexpr u8 NUM_ROWS = 8;
+
+    /* Timer 1 runs at F_CPU / 8: plane 0 lasts 0.5 ms, a cycle (2^NUM_BITS - 1) times that */
+    static constexpr u16 PLANE_TICKS = 1000;
+};
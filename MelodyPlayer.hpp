@@ -1,4 +1,5 @@
 #pragma once
+#include "Buzzer.hpp"
 #include "notes.hpp"
 #include <Arduino.h>
 
@@ -20,7 +21,6 @@ template <typename T> static u32 getTotalSlices(const T& notes)
 }
 
 static constexpr i32 SOUND_IS_ENABLED_DEFAULT = true;
-static i32 soundIsEnabled = true;
 
 struct MelodyPlayer {
 public:
@@ -34,38 +34,30 @@ public:
     {
     }
 
-    void init() { pinMode(BUZZER_PIN, OUTPUT); }
-
-    void play(const u32 currentTs)
+    /* The buzzer is only told about note changes, sound effects play over the melody */
+    void play(const u32 currentTs, const bool soundIsEnabled)
     {
         if (i == numNotes) {
             i = 0;
             past = currentTs;
+            Buzzer::setBackground(soundIsEnabled ? mel[i].freq : 0);
         }
 
-        const auto note = mel[i].freq;
-        if (note)
-            toneHelper(note);
-        else
-            noTone(BUZZER_PIN);
-
         if (currentTs - past > mel[i].slice * msPerSlice) {
             past = currentTs;
-            ++i;
+            if (++i < numNotes)
+                Buzzer::setBackground(soundIsEnabled ? mel[i].freq : 0);
         }
     }
 
-    void stop() { noTone(BUZZER_PIN); }
-
-    static constexpr u8 BUZZER_PIN = 3;
-
-public:
-    void toneHelper(u16 freq)
+    void stop()
     {
-        if (soundIsEnabled)
-            tone(BUZZER_PIN, freq);
+        i = numNotes;
+        Buzzer::setBackground(0);
     }
 
+    static constexpr u8 BUZZER_PIN = Buzzer::PIN;
+
 public:
     Melody mel;
     u16 numNotes;
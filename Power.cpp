@@ -0,0 +1,30 @@
+#include "Power.hpp"
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+/* Only here to wake the MCU up */
+ISR(PCINT2_vect) { }
+
+void Power::powerDown(const u8 wakePin)
+{
+    const u8 adcsra = ADCSRA;
+    ADCSRA = 0;
+
+    *digitalPinToPCMSK(wakePin) |= u8(_BV(digitalPinToPCMSKbit(wakePin)));
+    PCIFR = u8(_BV(digitalPinToPCICRbit(wakePin)));
+    *digitalPinToPCICR(wakePin) |= u8(_BV(digitalPinToPCICRbit(wakePin)));
+
+    /* An interrupt right after `sei` is only taken after `sleep_cpu`, so no wake-up is lost */
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    cli();
+    sleep_enable();
+    sleep_bod_disable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+
+    *digitalPinToPCICR(wakePin) &= u8(~_BV(digitalPinToPCICRbit(wakePin)));
+    *digitalPinToPCMSK(wakePin) &= u8(~_BV(digitalPinToPCMSKbit(wakePin)));
+
+    ADCSRA = adcsra;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "utils.hpp"
+
+struct Power {
+    /*
+     *  Puts the MCU in power-down sleep until `wakePin` changes level. The ADC is turned off
+     *  for the duration. Timer 0 is stopped as well, so `millis()` doesn't advance while
+     *  asleep. `wakePin` must be one of the PORTD pins (0-7), which share PCINT2.
+     */
+    static void powerDown(u8 wakePin);
+};
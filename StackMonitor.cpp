@@ -0,0 +1,58 @@
+#include "StackMonitor.hpp"
+#include <avr/io.h>
+
+/* Function declarations */
+static void paint() __attribute__((naked, used, section(".init1")));
+static u8* begin();
+
+/* Set by the linker and by `malloc` */
+extern u8 __heap_start;
+extern u8* __brkval;
+
+/*
+ *  Runs before the C runtime has set up the stack pointer and zeroed r1, so it is written in
+ *  assembly and can't return: the code of the next init section follows it.
+ */
+void paint()
+{
+    asm volatile("    ldi r30, lo8(__heap_start)\n"
+                 "    ldi r31, hi8(__heap_start)\n"
+                 "    ldi r24, %0\n"
+                 "    ldi r25, hi8(__stack)\n"
+                 "    rjmp 2f\n"
+                 "1:  st Z+, r24\n"
+                 "2:  cpi r30, lo8(__stack)\n"
+                 "    cpc r31, r25\n"
+                 "    brlo 1b\n"
+                 "    breq 1b\n"
+                 :
+                 : "M"(Stack::CANARY));
+}
+
+u16 Stack::unused()
+{
+    const u8* const first = begin();
+    const u8* const sp = reinterpret_cast<const u8*>(SP);
+
+    const u8* p = first;
+    while (p < sp && *p == CANARY)
+        ++p;
+
+    return u16(p - first);
+}
+
+/*
+ *  An interrupt taken meanwhile pushes right below the stack pointer, over paint that is then
+ *  laid again, so the use of that one interrupt goes unnoticed.
+ */
+void Stack::repaint()
+{
+    u8* const sp = reinterpret_cast<u8*>(SP);
+    for (u8* p = begin(); p < sp; ++p)
+        *p = CANARY;
+}
+
+u8* begin()
+{
+    return __brkval != nullptr ? __brkval : &__heap_start;
+}
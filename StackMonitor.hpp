@@ -0,0 +1,43 @@
+#pragma once
+#include "utils.hpp"
+
+/*
+ *  Free SRAM high-water marks. At reset, the RAM between the static data (or the heap) and the
+ *  stack is painted with a canary byte. `unused` counts how much of it the stack, interrupts
+ *  included, has not overwritten since: the least free RAM there has been. `repaint` starts a
+ *  new measurement from the current depth of the stack.
+ */
+struct Stack {
+    static u16 unused();
+    static void repaint();
+
+    static constexpr u8 CANARY = 0xC5;
+};
+
+/* The least free RAM seen while each state (identified by `Key`) was active */
+template <typename Key, u8 NUM_SLOTS> struct StackMonitor {
+public:
+    struct Slot {
+        Key key;
+        u16 minFree;
+    };
+
+    /* Whether `free` is a new low for `key`; keys that find no slot are not recorded */
+    bool record(const Key key, const u16 free)
+    {
+        for (auto& slot : slots) {
+            if (slot.key == key) {
+                if (free >= slot.minFree)
+                    return false;
+
+                slot.minFree = free;
+                return true;
+            }
+        }
+
+        return slots.push({ key, free });
+    }
+
+public:
+    Tiny::StaticVector<Slot, NUM_SLOTS> slots;
+};
@@ -0,0 +1,88 @@
+#include "StatsLog.hpp"
+#include "EepromWriter.hpp"
+#include <stddef.h>
+
+void StatsLog::init()
+{
+    head = 0;
+    nextSeq = 0;
+    sums = {};
+
+    u8 slot;
+    Record newest;
+    if (!findNewest(slot, newest))
+        return;
+
+    head = u8((slot + 1) % NUM_SLOTS);
+    nextSeq = u16(newest.seq + 1);
+    sums = newest.totals;
+}
+
+void StatsLog::append(const u8 level, const u8 reviews, const u16 seconds)
+{
+    if (sums.gamesPlayed != 0xFFFF)
+        ++sums.gamesPlayed;
+    if (level > sums.bestLevel)
+        sums.bestLevel = level;
+    sums.levels = u16(sums.levels + level);
+    sums.reviews = u16(sums.reviews + reviews);
+    sums.seconds += seconds;
+
+    /* Games last minutes and a record takes ~50 ms to write, so this hardly ever waits */
+    if (EepromWriter::isPending(&last))
+        EepromWriter::drain();
+
+    last = { nextSeq, level, reviews, seconds, sums, 0 };
+    last.crc = checksum(last);
+    EepromWriter::write(u16(BEGIN + head * sizeof(Record)), &last, sizeof(last));
+
+    head = u8((head + 1) % NUM_SLOTS);
+    ++nextSeq;
+}
+
+u8 StatsLog::checksum(const Record& record)
+{
+    return Tiny::crc8(&record, offsetof(Record, crc));
+}
+
+/* The newest valid record and its slot, false if there is none (an empty log) */
+bool StatsLog::findNewest(u8& slot, Record& newest)
+{
+    Record first;
+    if (read(0, first)) {
+        /* Find the first slot that isn't part of the lap that begins at slot 0 */
+        u8 low = 1;
+        u8 high = NUM_SLOTS;
+        while (low < high) {
+            const u8 mid = u8((low + high) / 2);
+
+            Record record;
+            if (read(mid, record) && record.seq == u16(first.seq + mid))
+                low = u8(mid + 1);
+            else
+                high = mid;
+        }
+
+        slot = u8(low - 1);
+        return read(slot, newest);
+    }
+
+    /* The ring holds consecutive sequence numbers, so they compare across their wrap-around */
+    bool found = false;
+    for (u8 i = 1; i < NUM_SLOTS; ++i) {
+        Record record;
+        if (read(i, record) && (!found || int16_t(record.seq - newest.seq) > 0)) {
+            slot = i;
+            newest = record;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool StatsLog::read(const u8 slot, Record& record)
+{
+    EepromWriter::read(u16(BEGIN + slot * sizeof(Record)), &record, sizeof(record));
+    return record.crc == checksum(record);
+}
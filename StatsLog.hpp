@@ -0,0 +1,56 @@
+#pragma once
+#include "utils.hpp"
+
+/*
+ *  Gameplay statistics kept as an append-only ring of records in EEPROM. Every record carries
+ *  the running totals, so the EEPROM is only read at boot (the newest record) and the writes
+ *  rotate over the whole region instead of wearing out a single cell.
+ *
+ *  Records are written in slot order with consecutive sequence numbers. A slot belongs to the
+ *  lap that starts at slot 0 when its checksum is valid and its sequence number is
+ *  `seq(0) + slot`; that holds for a prefix of the ring only, so the head is binary searched.
+ *  If slot 0 itself is invalid (a write to it was cut short), every slot is read instead.
+ */
+struct StatsLog {
+public:
+    struct Totals {
+        u16 gamesPlayed;
+        u8 bestLevel;
+        u16 levels;
+        u16 reviews;
+        u32 seconds;
+    };
+
+    /* Member functions */
+    void init();
+    void append(u8 level, u8 reviews, u16 seconds);
+    const Totals& totals() const { return sums; }
+
+    /* Static constexpr variables */
+    static constexpr u16 BEGIN = 128;
+    static constexpr u16 END = E2END + 1;
+
+private:
+    struct Record {
+        u16 seq;
+        u8 level;
+        u8 reviews;
+        u16 seconds;
+        Totals totals;
+        u8 crc;
+    };
+
+    static u8 checksum(const Record&);
+    static bool read(u8 slot, Record&);
+    static bool findNewest(u8& slot, Record&);
+
+    static constexpr u8 NUM_SLOTS = u8((END - BEGIN) / sizeof(Record));
+
+private:
+    /* Data members */
+    u8 head;
+    u16 nextSeq;
+    Totals sums;
+    /* Source of the newest record's write, which happens in the background */
+    Record last;
+};
@@ -3,22 +3,81 @@
 #include "EEPROM.h"
 #include "LedControl.h"
 #include "LiquidCrystal.h"
+#include "Log.hpp"
 
 static JoystickController joystickController;
+static GameController gameController;
+
+static void logLoopStats(const u32 beginUs)
+{
+    static constexpr u32 WINDOW_US = 1000000;
+
+    static u32 windowBeginUs = 0;
+    static u16 numFrames = 0;
+    static u32 maxFrameUs = 0;
+
+    const auto endUs = micros();
+    ++numFrames;
+    maxFrameUs = max(maxFrameUs, endUs - beginUs);
+
+    if (endUs - windowBeginUs >= WINDOW_US) {
+        Log::write<LogId::LoopStats>(numFrames, maxFrameUs);
+        if constexpr (Log::isEnabled(LogId::LatencyP95))
+            gameController.logLatency();
+        windowBeginUs = endUs;
+        numFrames = 0;
+        maxFrameUs = 0;
+    }
+}
+
+/*
+ *  Boot times, counted from the start of `micros()` shortly before `setup`: the end of the
+ *  first frame, and the sampling of the first input the game can react to (in the first frame
+ *  that runs the states, once the LCD is initialized).
+ */
+static void logBootTiming(const u32 sampleUs)
+{
+    static u32 firstFrameUs = 0;
+    static bool done = false;
+
+    if (done)
+        return;
+
+    if (firstFrameUs == 0) {
+        firstFrameUs = micros();
+    } else if (gameController.isReady()) {
+        Log::write<LogId::BootTiming>(firstFrameUs, sampleUs);
+        done = true;
+    }
+}
 
 void setup()
 {
+    Log::init();
     joystickController.init();
     gameController.init();
 }
 
 void loop()
 {
+    const auto sampleUs = micros();
     const auto currentTs = millis();
-    const auto joyPress = joystickController.getButtonValue(currentTs);
-    const auto joyDir = joystickController.getDirection();
+    const auto joyPress = joystickController.getButtonValue(sampleUs);
+    const auto joyDir = joystickController.getDirection(currentTs);
+    const auto joyRepeat = joystickController.isRepeat();
+
+    gameController.update({ currentTs, sampleUs, joyPress, joyDir, joyRepeat });
+
+    /* The press that wakes the board up is not meant for the current state */
+    if (gameController.isInactive(currentTs)) {
+        gameController.sleep();
+        joystickController.ignoreCurrentPress(micros());
+    }
 
-    gameController.update({ currentTs, joyPress, joyDir });
+    if constexpr (Log::isEnabled(LogId::BootTiming))
+        logBootTiming(sampleUs);
+    if constexpr (Log::isEnabled(LogId::LoopStats))
+        logLoopStats(sampleUs);
 }
 
 int main()
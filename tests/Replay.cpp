@@ -0,0 +1,160 @@
+#include "Replay.hpp"
+#include "Board.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace Replay;
+using Direction = JoystickController::Direction;
+using Press = JoystickController::Press;
+
+static const std::map<std::string, Press> PRESSES = {
+    { "press", Press::Short },
+    { "long", Press::Long },
+    { "double", Press::Double },
+};
+
+std::vector<Event> Replay::readScenario(const char* const path)
+{
+    FILE* const file = fopen(path, "r");
+    if (file == nullptr) {
+        perror(path);
+        exit(2);
+    }
+
+    std::vector<Event> events;
+    char line[128];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+
+        unsigned ts;
+        char input[16], repeat[16] = "";
+        if (sscanf(line, "%u %15s %15s", &ts, input, repeat) < 2) {
+            fprintf(stderr, "%s: bad line: %s", path, line);
+            exit(2);
+        }
+        events.push_back({ ts, input, std::string(repeat) == "repeat" });
+    }
+
+    fclose(file);
+    return events;
+}
+
+bool Replay::isPress(const Event& event) { return PRESSES.count(event.input) != 0; }
+
+Trace Replay::run(GameController& gc, const std::vector<Event>& events)
+{
+    static const std::map<std::string, Direction> DIRECTIONS = {
+        { "up", Direction::Up },
+        { "down", Direction::Down },
+        { "left", Direction::Left },
+        { "right", Direction::Right },
+    };
+    Trace trace = {};
+    /* The paint that the AVR lays at reset */
+    Stack::repaint();
+    gc.init();
+    Board::runInterrupts();
+
+    size_t next = 0;
+    for (u32 frameTs = 0; next < events.size(); frameTs += FRAME_MS) {
+        /* The I2C bus gets its bytes out in the background, between frames too */
+        const u32 lcdBytes = Board::lcdBusBytes();
+        Board::advanceTo(frameTs * 1000);
+
+        Input input = { millis(), micros(), Press::None, Direction::None, false };
+        while (next < events.size() && events[next].ts <= Board::nowUs() / 1000) {
+            const auto& event = events[next++];
+            if (DIRECTIONS.count(event.input)) {
+                input.joyDir = DIRECTIONS.at(event.input);
+                input.joyRepeat = event.repeat;
+            } else if (PRESSES.count(event.input)) {
+                input.joyPress = PRESSES.at(event.input);
+            } else if (event.input == "snapshot") {
+                trace.snapshots.push_back(snapshot(gc, Board::nowUs() / 1000));
+            } else if (event.input != "end") {
+                fprintf(stderr, "unknown input: %s\n", event.input.c_str());
+                exit(2);
+            }
+        }
+
+        const u16 matrixBytes = gc.matrix.controller.bytes;
+        gc.update(input);
+        Board::runInterrupts();
+
+        const Traffic frame = {
+            Board::lcdBusBytes() - lcdBytes,
+            u16(gc.matrix.controller.bytes - matrixBytes),
+        };
+        if (frame.lcdBytes || frame.matrixBytes) {
+            /* Frames that the game's own waits pushed into the same millisecond add up */
+            auto& traced = trace.frames[input.currentTs];
+            traced.lcdBytes += frame.lcdBytes;
+            traced.matrixBytes += frame.matrixBytes;
+            trace.total.lcdBytes += frame.lcdBytes;
+            trace.total.matrixBytes += frame.matrixBytes;
+        }
+
+        if (gc.isInactive(input.currentTs)) {
+            auto wake = next;
+            while (wake < events.size() && !isPress(events[wake]))
+                ++wake;
+            if (wake == events.size())
+                break;
+
+            const u32 asleepUs = Board::nowUs();
+            Board::pressButtonAt(events[wake].ts * 1000, [&]() {
+                for (; next < wake; ++next) {
+                    if (events[next].input == "snapshot")
+                        trace.snapshots.push_back(snapshot(gc, events[next].ts));
+                }
+            });
+            gc.sleep();
+            Board::runInterrupts();
+
+            /* The press is spent on waking the board up */
+            next = wake + 1;
+            trace.sleeps.push_back({ asleepUs, Board::nowUs() });
+            frameTs = Board::nowUs() / 1000;
+        }
+    }
+
+    for (const auto& slot : gc.latency.slots) {
+        if (slot.key == UpdateFunc {})
+            continue;
+
+        char name[GameController::NUM_COLS + 1] = "?";
+        GameController::stateName(slot.key, name);
+        const auto& histogram = slot.histogram;
+        trace.latencies[name] = { histogram.percentile(50), histogram.percentile(95),
+            histogram.maxUs, histogram.total };
+    }
+
+    for (const auto& slot : gc.stack.slots) {
+        char name[GameController::NUM_COLS + 1] = "?";
+        GameController::stateName(slot.key, name);
+        trace.stackBytes[name] = Board::STACK_BYTES - slot.minFree;
+    }
+
+    return trace;
+}
+
+std::string Replay::snapshot(const GameController& gc, const u32 ts)
+{
+    const auto& matrix = gc.matrix.controller;
+    std::string text = "snapshot " + std::to_string(ts) + "\n";
+
+    for (u8 row = 0; row < Board::LCD_ROWS; ++row) {
+        char lcdRow[4 * Board::LCD_COLS + 1];
+        Board::lcdRow(row, lcdRow);
+        text += std::string("lcd |") + lcdRow + "|" + (Board::lcdIsOn() ? "" : " off") + "\n";
+    }
+    for (u8 row = 0; row < GameController::MATRIX_SIZE; ++row) {
+        text += "matrix ";
+        for (u8 col = 0; col < GameController::MATRIX_SIZE; ++col)
+            text += matrix.rows[row] & (0x80 >> col) ? '#' : '.';
+        text += matrix.isShutdown ? " off\n" : "\n";
+    }
+
+    return text;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "GameController.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+ *  Replays of recorded input scenarios (in scenarios/) on the whole game, on the host board
+ *  (see host/Board.hpp), which trace the display traffic and the latency of the game. The LCD
+ *  traffic is what the board saw on the LCD's bus; the matrix's is the driver's count.
+ *
+ *  A scenario is a line per input, "<ms since boot> <input>", the input being a direction
+ *  (up, down, left, right), a press (press, long, double), "snapshot" or "end". A direction
+ *  followed by "repeat" is an auto-repeat of a held stick. Inputs last one frame; frames are
+ *  FRAME_MS apart, unless the game itself took longer.
+ *
+ *  Between frames, the game goes to sleep as the sketch's loop has it, once inactive. It
+ *  sleeps until the next press, which only wakes it up; the directions in between are lost
+ *  and the snapshots show the sleeping board. A scenario that lets the game sleep with no
+ *  press ahead ends there.
+ */
+namespace Replay {
+static constexpr u32 FRAME_MS = 2;
+
+struct Event {
+    u32 ts;
+    std::string input;
+    bool repeat;
+};
+
+struct Traffic {
+    u32 lcdBytes;
+    u32 matrixBytes;
+};
+
+struct Latency {
+    u32 p50Us;
+    u32 p95Us;
+    u32 maxUs;
+    u32 inputs;
+};
+
+/* Since power-on, sleep included (see `Board::nowUs`) */
+struct Sleep {
+    u32 asleepUs;
+    u32 awakeUs;
+};
+
+struct Trace {
+    std::map<u32, Traffic> frames;
+    Traffic total;
+    /* By state name */
+    std::map<std::string, Latency> latencies;
+    /* By state name, the most of the host's stack paint it used (see `Board::STACK_BYTES`) */
+    std::map<std::string, u32> stackBytes;
+    std::vector<Sleep> sleeps;
+    std::vector<std::string> snapshots;
+};
+
+std::vector<Event> readScenario(const char* path);
+bool isPress(const Event&);
+
+/* Boots the game on the board as it is and plays `events` */
+Trace run(GameController&, const std::vector<Event>&);
+
+/* Both displays, as a block of lines starting with "snapshot" */
+std::string snapshot(const GameController&, u32 ts);
+}
@@ -0,0 +1,245 @@
+#include "Coroutine.hpp"
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+/*
+ *  The coroutines against the switch-based sub-states that `gameUpdate` used before them, on
+ *  the sequence they replaced: wait for the transition animation, show the level's tiles
+ *  SHOW_TIME apart, then take a tile per press until the level is done. Both versions must
+ *  show and take the same tiles in the same frames (give or take one: the old code counted
+ *  from the last frame of the animation), then their cost per frame is timed.
+ */
+
+#define CHECK(cond)                                                                           \
+    do {                                                                                      \
+        if (!(cond)) {                                                                        \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                   \
+            ++failures;                                                                       \
+        }                                                                                     \
+    } while (0)
+
+struct Input {
+    u32 currentTs;
+    u8 joyPress;
+    u8 joyDir;
+};
+
+enum class Event : u8 {
+    LevelStart = 0,
+    Show,
+    Take,
+};
+
+struct Record {
+    Event event;
+    u8 value;
+    u32 ts;
+};
+
+/* What both versions share: the level, the animation and what they did */
+struct Game {
+    u8 level = 1;
+    u8 captured = 0;
+    u32 animationEndTs = 0;
+    std::vector<Record>* records = nullptr;
+    u32 numRecords = 0;
+
+    void record(const Event event, const u8 value, const u32 ts)
+    {
+        ++numRecords;
+        if (records != nullptr)
+            records->push_back({ event, value, ts });
+    }
+};
+
+/* As the sub-states of `gameUpdate` were, minus the display and the reviews */
+struct SwitchGame : Game {
+    u8 subState = 0;
+    u8 tileIdx = 0;
+    bool entry = true;
+    u32 beginTs = 0;
+};
+
+struct CoroutineGame : Game {
+    u8 tileIdx = 0;
+    Coroutine co = {};
+};
+
+/* Function declarations */
+static void switchUpdate(SwitchGame&, const Input&) __attribute__((noinline));
+static void coroutineUpdate(CoroutineGame&, const Input&) __attribute__((noinline));
+template <typename G, typename Update> static void play(G&, Update, u32 frames);
+template <typename G, typename Update>
+static double nsPerFrame(Update, u32 frames, u32& numRecords);
+
+static constexpr u32 SHOW_TIME = 500;
+static constexpr u32 ANIMATION_MS = 300;
+/* A press every so many frames (1 ms each), so that levels go by */
+static constexpr u32 PRESS_EVERY = 40;
+static constexpr u32 CHECKED_FRAMES = 200000;
+static constexpr u32 TIMED_FRAMES = 20000000;
+
+static int failures = 0;
+
+int main()
+{
+    std::vector<Record> switchRecords, coroutineRecords;
+    SwitchGame switchGame;
+    switchGame.records = &switchRecords;
+    play(switchGame, &switchUpdate, CHECKED_FRAMES);
+
+    CoroutineGame coroutineGame;
+    coroutineGame.records = &coroutineRecords;
+    play(coroutineGame, &coroutineUpdate, CHECKED_FRAMES);
+
+    CHECK(switchRecords.size() == coroutineRecords.size());
+    CHECK(switchGame.level == coroutineGame.level && switchGame.level > 10);
+    for (size_t i = 0; i < switchRecords.size() && i < coroutineRecords.size(); ++i) {
+        const auto& old = switchRecords[i];
+        const auto& now = coroutineRecords[i];
+        if (old.event != now.event || old.value != now.value || now.ts - old.ts > 1) {
+            printf("record %zu: was %u %u at %u ms, is %u %u at %u ms\n", i, u8(old.event),
+                old.value, old.ts, u8(now.event), now.value, now.ts);
+            ++failures;
+            break;
+        }
+    }
+
+    /* The timed runs must have done the same, give or take the last frame's record */
+    u32 switchNumRecords, coroutineNumRecords;
+    const double switchNs
+        = nsPerFrame<SwitchGame>(&switchUpdate, TIMED_FRAMES, switchNumRecords);
+    const double coroutineNs
+        = nsPerFrame<CoroutineGame>(&coroutineUpdate, TIMED_FRAMES, coroutineNumRecords);
+    CHECK(max(switchNumRecords, coroutineNumRecords)
+            - min(switchNumRecords, coroutineNumRecords)
+        <= 1);
+    printf("%-24s %8.2f ns/frame\n", "switch sub-states", switchNs);
+    printf("%-24s %8.2f ns/frame\n", "coroutine", coroutineNs);
+
+    printf("coroutine_test: %d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
+
+void switchUpdate(SwitchGame& game, const Input& input)
+{
+    enum class State : u8 {
+        NextLevel = 0,
+        ShowLevel,
+        Playing,
+    };
+
+    const u8 numTiles = game.level;
+    if (game.entry) {
+        game.entry = false;
+
+        if (game.subState == u8(State::NextLevel)) {
+            game.record(Event::LevelStart, game.level, input.currentTs);
+            game.animationEndTs = input.currentTs + ANIMATION_MS;
+            game.subState = u8(State::ShowLevel);
+        }
+    }
+
+    switch (game.subState) {
+    case u8(State::ShowLevel): {
+        if (input.currentTs < game.animationEndTs) {
+            game.beginTs = input.currentTs;
+            break;
+        }
+
+        const auto onTime = SHOW_TIME / 2;
+        const u32 intervalNum = (input.currentTs - game.beginTs) / onTime;
+        if (intervalNum % 2 && (intervalNum + 1) / 2 == game.tileIdx + 1u) {
+            if (game.tileIdx < numTiles)
+                game.record(Event::Show, game.tileIdx, input.currentTs);
+            ++game.tileIdx;
+        }
+
+        if (game.tileIdx == numTiles + 1) {
+            game.entry = true;
+            game.subState = u8(State::Playing);
+        }
+        break;
+    }
+    case u8(State::Playing):
+        if (!input.joyPress)
+            break;
+
+        game.record(Event::Take, game.captured, input.currentTs);
+        if (++game.captured == numTiles) {
+            ++game.level;
+            game.captured = 0;
+            game.tileIdx = 0;
+            game.entry = true;
+            game.subState = u8(State::NextLevel);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void coroutineUpdate(CoroutineGame& game, const Input& input)
+{
+    auto& co = game.co;
+    const u8 numTiles = game.level;
+
+    CO_BEGIN(co);
+
+    for (;;) {
+        game.record(Event::LevelStart, game.level, input.currentTs);
+        game.animationEndTs = input.currentTs + ANIMATION_MS;
+
+        CO_AWAIT(co, input.currentTs >= game.animationEndTs);
+
+        CO_AWAIT_MS(co, input.currentTs, SHOW_TIME / 2);
+        for (game.tileIdx = 0; game.tileIdx < numTiles; ++game.tileIdx) {
+            game.record(Event::Show, game.tileIdx, input.currentTs);
+            CO_AWAIT_MS(co, input.currentTs, SHOW_TIME);
+        }
+
+        for (game.captured = 0; game.captured < numTiles;) {
+            CO_YIELD(co);
+            if (!input.joyPress)
+                continue;
+
+            game.record(Event::Take, game.captured, input.currentTs);
+            ++game.captured;
+        }
+
+        ++game.level;
+        CO_YIELD(co);
+    }
+
+    CO_END;
+}
+
+template <typename G, typename Update> void play(G& game, Update update, const u32 frames)
+{
+    for (u32 ts = 0; ts < frames; ++ts) {
+        const Input input = { ts, u8(ts % PRESS_EVERY == 0), 0 };
+        update(game, input);
+    }
+}
+
+/* Levels are restarted every so often, so that the time isn't spent in the long ones */
+template <typename G, typename Update>
+double nsPerFrame(Update update, const u32 frames, u32& numRecords)
+{
+    static constexpr u8 MAX_LEVEL = 20;
+
+    G game;
+    const auto begin = std::chrono::steady_clock::now();
+    for (u32 ts = 0; ts < frames; ++ts) {
+        const Input input = { ts, u8(ts % PRESS_EVERY == 0), 0 };
+        update(game, input);
+        if (game.level > MAX_LEVEL)
+            game.level = 1;
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    numRecords = game.numRecords;
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    return double(ns) / frames;
+}
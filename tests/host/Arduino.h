@@ -0,0 +1,75 @@
+/*
+ *  The parts of the Arduino core that the sketch uses, for a native build of the host tests.
+ *  Program memory is plain memory. Time only moves when the test moves it (see Board.hpp),
+ *  by as much as the code waits for, or by what a `digitalWrite` costs on the Uno.
+ */
+
+#pragma once
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+using u8 = uint8_t;
+using u16 = uint16_t;
+using u32 = uint32_t;
+using byte = uint8_t;
+
+#define F_CPU 16000000UL
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+/* The Uno's analog pins, as digital pins */
+static constexpr u8 A0 = 14, A1 = 15, A2 = 16, A3 = 17, A4 = 18, A5 = 19;
+static constexpr u8 SDA = A4, SCL = A5;
+
+/* Functions instead of the core's macros, which would break the standard headers */
+template <typename T, typename U> using Common = typename std::common_type<T, U>::type;
+template <typename T, typename U> Common<T, U> min(const T& a, const U& b)
+{
+    return b < a ? b : a;
+}
+template <typename T, typename U> Common<T, U> max(const T& a, const U& b)
+{
+    return a < b ? b : a;
+}
+
+void pinMode(u8 pin, u8 mode);
+void digitalWrite(u8 pin, u8 value);
+int digitalRead(u8 pin);
+void analogWrite(u8 pin, int value);
+int analogRead(u8 pin);
+/* `unsigned long` is 32 bits on the AVR */
+u32 millis();
+u32 micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+class Print {
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(u8) = 0;
+    virtual size_t write(const u8* buffer, size_t size)
+    {
+        size_t written = 0;
+        while (size--)
+            written += write(*buffer++);
+        return written;
+    }
+    size_t write(const char* buffer, const size_t size)
+    {
+        return write(reinterpret_cast<const u8*>(buffer), size);
+    }
+    size_t write(const char* str) { return write(str, strlen(str)); }
+    size_t print(const char* str) { return write(str); }
+    size_t print(const char c) { return write(u8(c)); }
+};
@@ -0,0 +1,463 @@
+#include "Board.hpp"
+#include "FastPin.hpp"
+#include "GameController.hpp"
+#include "LcdI2c.hpp"
+#include "Power.hpp"
+#include "StackMonitor.hpp"
+#include <avr/eeprom.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <util/twi.h>
+
+/*
+ *  The HD44780 as wired to the parallel driver: it latches RS and D4..D7 as EN falls, and
+ *  starts in 8-bit mode, where each nibble is a whole instruction with its low bits floating
+ *  low, until a function set selects 4-bit mode.
+ */
+struct Hd44780 {
+public:
+    Hd44780() { memset(ddram, ' ', sizeof(ddram)); }
+
+    /* The pins as the code's next wait finds them: a fall of EN since the last one latches */
+    void sample(bool en, bool rs, u8 nibble);
+    void latch(bool rs, u8 nibble);
+
+private:
+    void execute(bool rs, u8 value);
+
+public:
+    /* Bytes taken in 4-bit mode, as pairs of nibbles */
+    u32 bytes = 0;
+    u8 ddram[0x80];
+    u8 cgram[0x40] = {};
+    u8 addr = 0;
+    bool cgramSelected = false;
+    bool fourBit = false;
+    bool highLatched = false;
+    u8 high = 0;
+    bool displayOn = false;
+    bool en = false;
+};
+
+using Rs = FastPin<GameController::RS_PIN>;
+using En = FastPin<GameController::ENABLE_PIN>;
+using D4 = FastPin<GameController::D4>;
+using D5 = FastPin<GameController::D5>;
+using D6 = FastPin<GameController::D6>;
+using D7 = FastPin<GameController::D7>;
+
+/*
+ *  The TWI in master transmitter mode, with the PCF8574 backpack at LCD_I2C_ADDRESS on the
+ *  bus: its outputs are RS, RW, EN, the backlight and D4..D7, and the HD44780 latches D4..D7
+ *  when EN falls. Each action that a write of TWCR sets off takes its time on the bus at
+ *  SCL_FREQ, after the previous one, and ends by raising TWINT and running the interrupt (a
+ *  stop condition by clearing TWSTO). Actions end as the clock moves past them, or when the
+ *  code reads TWCR, which it only does to wait for the bus: the clock then moves to the end of
+ *  the action.
+ */
+struct Twi {
+public:
+    enum class Action : u8 {
+        None = 0,
+        Start,
+        Send,
+        Stop,
+    };
+
+    void set(u8 value);
+    void runUntil(double us);
+    void finish();
+
+    static constexpr double BIT_US = 1e6 / LcdI2c::SCL_FREQ;
+    static constexpr u8 EXPANDER_RS = _BV(0);
+    static constexpr u8 EXPANDER_EN = _BV(2);
+
+public:
+    u8 control = 0;
+    Action action = Action::None;
+    u8 data = 0;
+    double endUs = 0;
+    bool addressed = false;
+    bool toExpander = false;
+    u8 expander = 0;
+    /* Bytes on the bus, addresses included */
+    u32 bytes = 0;
+};
+
+extern "C" void EE_READY_vect();
+extern "C" void TWI_vect();
+
+/* Function declarations */
+static void wait(double us);
+static u8* stackPaint() __attribute__((noinline));
+static u8* frameTop() __attribute__((noinline));
+
+/*
+ *  What a `digitalWrite` costs on the Uno, with its table lookups in program memory and the
+ *  PWM check: about 56 cycles. The sketch's register accesses are taken as free.
+ */
+static constexpr double DIGITAL_WRITE_US = 56 * 1e6 / F_CPU;
+
+thread_local volatile u8 PORTB, PORTC, PORTD, DDRB, DDRC, DDRD, PINB, PINC, PIND;
+thread_local volatile u8 SREG, MCUCR, SMCR, PRR, ADCSRA;
+thread_local volatile u8 EECR, EEDR;
+thread_local volatile u16 EEAR;
+thread_local volatile u8 PCICR, PCMSK2, PCIFR, EIMSK, EIFR, EICRA;
+thread_local volatile u8 TCCR1A, TCCR1B, TIMSK1, TIFR1;
+thread_local volatile u16 OCR1A, TCNT1;
+thread_local volatile u8 TCCR2A, TCCR2B, OCR2A, OCR2B, TIMSK2, TIFR2, TCNT2;
+thread_local volatile u8 UCSR0A, UCSR0B, UCSR0C, UDR0;
+thread_local volatile u16 UBRR0;
+thread_local volatile u8 TWBR, TWSR, TWDR;
+thread_local TwiControl TWCR;
+
+static thread_local double clockUs = 0;
+/* How long Timer 0 stood still, asleep, which `micros` leaves out */
+static thread_local double stoppedUs = 0;
+static thread_local struct Press {
+    bool pending = false;
+    u32 us = 0;
+    std::function<void()> whileAsleep;
+} press;
+static thread_local Hd44780 lcd;
+static thread_local struct {
+    u8* first = nullptr;
+    u8* top = nullptr;
+} stack;
+static thread_local Twi twi;
+static thread_local struct Eeprom {
+    Eeprom() { memset(bytes, 0xFF, sizeof(bytes)); }
+
+    u8 bytes[E2END + 1];
+} eeprom;
+
+void Hd44780::sample(const bool en, const bool rs, const u8 nibble)
+{
+    if (this->en && !en)
+        latch(rs, nibble);
+    this->en = en;
+}
+
+void Hd44780::latch(const bool rs, const u8 nibble)
+{
+    if (!fourBit) {
+        execute(rs, u8(nibble << 4));
+        return;
+    }
+
+    if (!highLatched) {
+        high = nibble;
+        highLatched = true;
+        return;
+    }
+
+    highLatched = false;
+    ++bytes;
+    execute(rs, u8(high << 4 | nibble));
+}
+
+void Hd44780::execute(const bool rs, const u8 value)
+{
+    if (rs) {
+        if (cgramSelected)
+            cgram[addr & 0x3F] = value;
+        else
+            ddram[addr & 0x7F] = value;
+        addr = u8((addr + 1) & 0x7F);
+        return;
+    }
+
+    if (value & LCD_SETDDRAMADDR) {
+        addr = value & 0x7F;
+        cgramSelected = false;
+    } else if (value & LCD_SETCGRAMADDR) {
+        addr = value & 0x3F;
+        cgramSelected = true;
+    } else if (value & LCD_FUNCTIONSET) {
+        fourBit = !(value & 0x10);
+    } else if (value & LCD_CURSORSHIFT) {
+        /* The sketch never shifts the display */
+    } else if (value & LCD_DISPLAYCONTROL) {
+        displayOn = value & LCD_DISPLAYON;
+    } else if (value & LCD_ENTRYMODESET) {
+        /* The sketch only writes left to right */
+    } else if (value & LCD_RETURNHOME) {
+        addr = 0;
+        cgramSelected = false;
+    } else if (value & LCD_CLEARDISPLAY) {
+        memset(ddram, ' ', sizeof(ddram));
+        addr = 0;
+        cgramSelected = false;
+    }
+}
+
+void Twi::set(const u8 value)
+{
+    /* Writing TWINT clears it and sets the bus off */
+    control = value & u8(~_BV(TWINT));
+    action = Action::None;
+    if (!(value & _BV(TWEN)))
+        return;
+
+    double bits = 0;
+    if (value & _BV(TWSTO)) {
+        action = Action::Stop;
+        bits = 1;
+    } else if (value & _BV(TWSTA)) {
+        action = Action::Start;
+        bits = 1;
+    } else if (value & _BV(TWINT)) {
+        action = Action::Send;
+        data = TWDR;
+        bits = 9;
+    }
+    endUs = max(endUs, clockUs) + bits * BIT_US;
+}
+
+void Twi::runUntil(const double us)
+{
+    while (action != Action::None && endUs <= us)
+        finish();
+}
+
+void Twi::finish()
+{
+    const auto finished = action;
+    action = Action::None;
+
+    u8 status = 0;
+    switch (finished) {
+    case Action::Start:
+        status = addressed ? TW_REP_START : TW_START;
+        addressed = false;
+        break;
+    case Action::Send:
+        ++bytes;
+        if (!addressed) {
+            addressed = true;
+            toExpander = data == (GameController::LCD_I2C_ADDRESS << 1 | TW_WRITE);
+            status = toExpander ? TW_MT_SLA_ACK : TW_MT_SLA_NACK;
+            break;
+        }
+
+        if (toExpander) {
+            if (expander & EXPANDER_EN && !(data & EXPANDER_EN))
+                lcd.latch(expander & EXPANDER_RS, u8(expander >> 4));
+            expander = data;
+        }
+        status = TW_MT_DATA_ACK;
+        break;
+    case Action::Stop:
+        control &= u8(~_BV(TWSTO));
+        addressed = false;
+        return;
+    case Action::None:
+        return;
+    }
+
+    TWSR = u8((TWSR & 0x07) | status);
+    control |= _BV(TWINT);
+    if (control & _BV(TWIE))
+        TWI_vect();
+}
+
+TwiControl& TwiControl::operator=(const u8 value)
+{
+    twi.set(value);
+    return *this;
+}
+
+TwiControl::operator u8()
+{
+    if (twi.action != Twi::Action::None) {
+        clockUs = max(clockUs, twi.endUs);
+        twi.finish();
+    }
+    return twi.control;
+}
+
+void Board::reset()
+{
+    PORTB = PORTC = PORTD = DDRB = DDRC = DDRD = PINB = PINC = PIND = 0;
+    SREG = MCUCR = SMCR = PRR = ADCSRA = 0;
+    EECR = EEDR = 0;
+    EEAR = 0;
+    PCICR = PCMSK2 = PCIFR = EIMSK = EIFR = EICRA = 0;
+    TCCR1A = TCCR1B = TIMSK1 = TIFR1 = 0;
+    OCR1A = TCNT1 = 0;
+    TCCR2A = TCCR2B = OCR2A = OCR2B = TIMSK2 = TIFR2 = TCNT2 = 0;
+    UCSR0A = UCSR0B = UCSR0C = UDR0 = 0;
+    UBRR0 = 0;
+    TWBR = TWSR = TWDR = 0;
+
+    clockUs = 0;
+    stoppedUs = 0;
+    stack = {};
+    press = Press();
+    lcd = Hd44780();
+    twi = Twi();
+    eeprom = Eeprom();
+}
+
+void Board::advanceTo(const u32 us)
+{
+    clockUs = max(clockUs, double(us));
+    twi.runUntil(clockUs);
+}
+
+void Board::runInterrupts()
+{
+    while (EECR & _BV(EERIE)) {
+        EE_READY_vect();
+        if (EECR & _BV(EEPE)) {
+            eeprom.bytes[EEAR] = EEDR;
+            EECR &= u8(~(_BV(EEPE) | _BV(EEMPE)));
+        }
+    }
+}
+
+void Board::lcdRow(const u8 row, char (&text)[4 * LCD_COLS + 1])
+{
+    char* out = text;
+    for (u8 col = 0; col < LCD_COLS; ++col) {
+        const u8 c = lcd.ddram[row * 0x40 + col];
+        if (c < 8)
+            out += sprintf(out, "\\%u", c);
+        else if (c >= ' ' && c <= '~' && c != '\\')
+            *out++ = char(c);
+        else
+            out += sprintf(out, "\\x%02X", c);
+    }
+    *out = '\0';
+}
+
+bool Board::lcdIsOn() { return lcd.displayOn; }
+
+u32 Board::nowUs() { return u32(uint64_t(clockUs)); }
+
+void Board::pressButtonAt(const u32 us, std::function<void()> whileAsleep)
+{
+    press.pending = true;
+    press.us = us;
+    press.whileAsleep = std::move(whileAsleep);
+}
+
+u32 Board::lcdBusBytes()
+{
+#if LCD_BACKEND == LCD_BACKEND_I2C
+    return twi.bytes;
+#else
+    return lcd.bytes;
+#endif
+}
+
+/* The HD44780 sees the pins change between the waits, which every driver has after EN falls */
+void wait(const double us)
+{
+    const u8 nibble = u8((D4::port() & D4::MASK ? 0x1 : 0) | (D5::port() & D5::MASK ? 0x2 : 0)
+        | (D6::port() & D6::MASK ? 0x4 : 0) | (D7::port() & D7::MASK ? 0x8 : 0));
+    lcd.sample(En::port() & En::MASK, Rs::port() & Rs::MASK, nibble);
+
+    clockUs += us;
+    twi.runUntil(clockUs);
+}
+
+void _delay_us(const double us) { wait(us); }
+
+void delayMicroseconds(const unsigned int us) { wait(us); }
+
+void delay(const unsigned long ms)
+{
+    clockUs += 1000.0 * double(ms);
+    twi.runUntil(clockUs);
+}
+u32 micros() { return u32(uint64_t(clockUs - stoppedUs)); }
+u32 millis() { return u32(uint64_t(clockUs - stoppedUs) / 1000); }
+
+void pinMode(u8, u8) { }
+
+void digitalWrite(const u8 pin, const u8 value)
+{
+    volatile u8& port = pin < 8 ? PORTD : (pin < 14 ? PORTB : PORTC);
+    const u8 mask = u8(1 << (pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14)));
+    port = value ? u8(port | mask) : u8(port & ~mask);
+    wait(DIGITAL_WRITE_US);
+}
+int digitalRead(u8) { return HIGH; }
+void analogWrite(u8, int) { }
+int analogRead(u8) { return 512; }
+
+uint8_t eeprom_read_byte(const uint8_t* const addr)
+{
+    return eeprom.bytes[reinterpret_cast<uintptr_t>(addr)];
+}
+
+void eeprom_read_block(void* const dst, const void* const src, const size_t size)
+{
+    memcpy(dst, &eeprom.bytes[reinterpret_cast<uintptr_t>(src)], size);
+}
+
+/*
+ *  The paint lies on the host's stack, the STACK_BYTES up to a margin below the frame of the
+ *  first call on the board, which lays it (the red zone under a function's stack pointer is
+ *  its own). `repaint` goes up to the same margin below its own frame, if that is lower.
+ */
+u16 Stack::unused()
+{
+    const u8* const first = stackPaint();
+    const u8* p = first;
+    while (p < stack.top && *p == CANARY)
+        ++p;
+
+    return u16(p - first);
+}
+
+void Stack::repaint()
+{
+    u8* const first = stackPaint();
+    u8* const top = min(stack.top, frameTop());
+    for (u8* p = first; p < top; ++p)
+        *p = CANARY;
+}
+
+u8* stackPaint()
+{
+    if (stack.first == nullptr) {
+        stack.top = frameTop();
+        stack.first = stack.top - Board::STACK_BYTES;
+        for (u8* p = stack.first; p < stack.top; ++p)
+            *p = Stack::CANARY;
+    }
+    return stack.first;
+}
+
+u8* frameTop()
+{
+    static constexpr uintptr_t MARGIN = 512;
+    const auto frame = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+    return reinterpret_cast<u8*>(frame - MARGIN);
+}
+
+/*
+ *  Sleeps until the press that the test set up, then for as long as the crystal oscillator
+ *  takes to start up again: 16K clock cycles with the Uno's fuses (CKSEL = 1111, SUT = 11).
+ *  Timer 0 stands still all along.
+ */
+void Power::powerDown(u8)
+{
+    static constexpr double WAKE_UP_US = 16384 * 1e6 / F_CPU;
+
+    if (!press.pending) {
+        fprintf(stderr, "the board went to sleep with no press to wake it up\n");
+        exit(2);
+    }
+
+    if (press.whileAsleep)
+        press.whileAsleep();
+    press.pending = false;
+
+    const double asleepUs = clockUs;
+    clockUs = max(clockUs, double(press.us)) + WAKE_UP_US;
+    stoppedUs += clockUs - asleepUs;
+    twi.runUntil(clockUs);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+
+/*
+ *  The Uno the sketch runs on in the host tests: a clock that the test moves, the registers,
+ *  the EEPROM, and an HD44780 that shows what the LCD driver puts on it, on the pins of
+ *  `GameController` or behind the I2C backpack on the TWI. The EEPROM interrupt runs when the
+ *  test calls `runInterrupts`, between frames, and the TWI one as the bus gets its bytes out
+ *  (see Board.cpp); nothing runs the timer ones, so the buzzer and the grayscale matrix stay
+ *  silent. The power-down sleep lasts until a press that the test sets up, plus the time the
+ *  oscillator takes to start up again.
+ *
+ *  Each thread has a board of its own, with the state of the sketch's drivers (see
+ *  `BOARD_LOCAL` in utils.hpp), so that games can run side by side, one per thread.
+ */
+namespace Board {
+static constexpr u8 LCD_ROWS = 2;
+static constexpr u8 LCD_COLS = 16;
+/*
+ *  The free RAM that the stack monitor measures (see StackMonitor.hpp) is out of this much of
+ *  the host's stack. The host's frames are not the AVR's: the figures only compare with each
+ *  other.
+ */
+static constexpr u16 STACK_BYTES = 16384;
+
+/*
+ *  Puts the board back as at power-on: the clock at 0, the registers and the LCD cleared, the
+ *  EEPROM erased, and the stack paint gone until the next call of `Stack` lays it. The
+ *  drivers' state is only new on a new thread: the code run before must leave them idle.
+ */
+void reset();
+
+/* Moves the clock forward to `us`, unless the code already waited past it */
+void advanceTo(u32 us);
+
+/* The time since power-on, sleep included, which `micros` leaves out (see Power.hpp) */
+u32 nowUs();
+
+/*
+ *  The button goes down at `us` (see `nowUs`), which wakes the board up from the power-down
+ *  sleep, after `whileAsleep` has run on the sleeping board. Going to sleep without a press
+ *  ahead is an error: the board would never wake up.
+ */
+void pressButtonAt(u32 us, std::function<void()> whileAsleep);
+
+/* Runs the enabled EEPROM interrupt until its queue is done, the writes completing at once */
+void runInterrupts();
+
+/* What the LCD shows on `row`; characters outside printable ASCII are escaped ("\1") */
+void lcdRow(u8 row, char (&text)[4 * LCD_COLS + 1]);
+bool lcdIsOn();
+
+/*
+ *  The bytes that went to the LCD: all those on the I2C bus, addresses included, through the
+ *  backpack, or those the HD44780 took on its pins, the lone nibbles of its initialization
+ *  aside
+ */
+u32 lcdBusBytes();
+}
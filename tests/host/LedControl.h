@@ -0,0 +1,26 @@
+#pragma once
+#include <Arduino.h>
+
+/*
+ *  Stand-in for the MAX7219 driver that keeps the image it would show instead of sending it,
+ *  one device only.
+ */
+class LedControl {
+public:
+    LedControl(int, int, int, int = 1) { }
+
+    void shutdown(int, const bool status) { isShutdown = status; }
+    void setIntensity(int, const int value) { intensity = u8(value); }
+    void clearDisplay(int) { memset(rows, 0, sizeof(rows)); }
+    void setLed(int, const int row, const int col, const bool state)
+    {
+        const u8 mask = u8(0x80 >> col);
+        rows[row] = state ? u8(rows[row] | mask) : u8(rows[row] & ~mask);
+    }
+    void setRow(int, const int row, const u8 value) { rows[row] = value; }
+
+public:
+    u8 rows[8] = {};
+    u8 intensity = 0;
+    bool isShutdown = true;
+};
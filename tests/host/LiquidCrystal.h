@@ -0,0 +1,21 @@
+#pragma once
+#include <Arduino.h>
+
+/* The HD44780 instructions, which the LCD drivers take from here */
+#define LCD_CLEARDISPLAY 0x01
+#define LCD_RETURNHOME 0x02
+#define LCD_ENTRYMODESET 0x04
+#define LCD_DISPLAYCONTROL 0x08
+#define LCD_CURSORSHIFT 0x10
+#define LCD_FUNCTIONSET 0x20
+#define LCD_SETCGRAMADDR 0x40
+#define LCD_SETDDRAMADDR 0x80
+
+#define LCD_ENTRYLEFT 0x02
+#define LCD_ENTRYSHIFTDECREMENT 0x00
+#define LCD_DISPLAYON 0x04
+#define LCD_CURSORON 0x02
+#define LCD_BLINKON 0x01
+#define LCD_4BITMODE 0x00
+#define LCD_2LINE 0x08
+#define LCD_5x8DOTS 0x00
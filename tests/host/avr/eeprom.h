@@ -0,0 +1,8 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* The EEPROM is the board's (see Board.cpp), and its writes complete at once */
+uint8_t eeprom_read_byte(const uint8_t* addr);
+void eeprom_read_block(void* dst, const void* src, size_t size);
+#define eeprom_busy_wait()
@@ -0,0 +1,7 @@
+#pragma once
+#include <avr/io.h>
+
+/* Vectors are plain functions, which Board.cpp calls when the sketch has enabled them */
+#define ISR(vector) extern "C" void vector()
+#define sei()
+#define cli()
@@ -0,0 +1,59 @@
+/*
+ *  The ATmega328P's registers that the sketch uses, as plain memory (see Board.cpp): writing
+ *  them sets nothing off, apart from what Board.cpp emulates, and TWCR, which drives its TWI.
+ *  Each thread has a board, and so registers, of its own.
+ */
+
+#pragma once
+#include <stdint.h>
+
+#define _BV(bit) (1U << (bit))
+
+extern thread_local volatile uint8_t PORTB, PORTC, PORTD, DDRB, DDRC, DDRD, PINB, PINC, PIND;
+extern thread_local volatile uint8_t SREG, MCUCR, SMCR, PRR, ADCSRA;
+extern thread_local volatile uint8_t EECR, EEDR;
+extern thread_local volatile uint16_t EEAR;
+extern thread_local volatile uint8_t PCICR, PCMSK2, PCIFR, EIMSK, EIFR, EICRA;
+extern thread_local volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+extern thread_local volatile uint16_t OCR1A, TCNT1;
+extern thread_local volatile uint8_t TCCR2A, TCCR2B, OCR2A, OCR2B, TIMSK2, TIFR2, TCNT2;
+extern thread_local volatile uint8_t UCSR0A, UCSR0B, UCSR0C, UDR0;
+extern thread_local volatile uint16_t UBRR0;
+extern thread_local volatile uint8_t TWBR, TWSR, TWDR;
+
+/* Writing TWCR sets the bus off; the code only reads it to wait for the bus, which moves on */
+struct TwiControl {
+    TwiControl& operator=(uint8_t);
+    operator uint8_t();
+};
+extern thread_local TwiControl TWCR;
+
+#define E2END 0x3FF
+
+#define EERE 0
+#define EEPE 1
+#define EEMPE 2
+#define EERIE 3
+#define WGM12 3
+#define WGM21 1
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define COM2B0 4
+#define OCIE1A 1
+#define OCF1A 1
+#define OCIE2A 1
+#define OCF2A 1
+#define TXEN0 3
+#define UDRIE0 5
+#define U2X0 1
+#define UCSZ00 1
+#define UCSZ01 2
+#define TWINT 7
+#define TWSTA 5
+#define TWSTO 4
+#define TWEN 2
+#define TWIE 0
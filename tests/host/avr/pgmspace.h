@@ -0,0 +1,8 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+/* The host has a single address space */
+#define PROGMEM
+#define memcpy_P memcpy
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t*>(addr))
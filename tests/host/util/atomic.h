@@ -0,0 +1,8 @@
+#pragma once
+
+/*
+ *  Interrupts only run between frames, or while the code waits (see Board.cpp), which it
+ *  doesn't in these blocks: every block is atomic
+ */
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_BLOCK(type) for (bool once = true; once; once = false)
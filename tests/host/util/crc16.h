@@ -0,0 +1,11 @@
+#pragma once
+#include <stdint.h>
+
+/* avr-libc's reference implementation: polynomial x^8 + x^2 + x + 1, no reflection */
+static inline uint8_t _crc8_ccitt_update(uint8_t crc, uint8_t data)
+{
+    data ^= crc;
+    for (uint8_t i = 0; i < 8; ++i)
+        data = data & 0x80 ? uint8_t(data << 1 ^ 0x07) : uint8_t(data << 1);
+    return data;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+/* Board.cpp latches the LCD's inputs on the delays that hold its enable pin */
+void _delay_us(double us);
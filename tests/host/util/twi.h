@@ -0,0 +1,11 @@
+#pragma once
+#include <avr/io.h>
+
+/* The master transmitter's status codes, which Board.cpp's TWI reports */
+#define TW_STATUS (TWSR & 0xF8)
+#define TW_START 0x08
+#define TW_REP_START 0x10
+#define TW_MT_SLA_ACK 0x18
+#define TW_MT_SLA_NACK 0x20
+#define TW_MT_DATA_ACK 0x28
+#define TW_WRITE 0
@@ -0,0 +1,171 @@
+#include "Board.hpp"
+#include "GameController.hpp"
+#include "LcdParallel.hpp"
+#include <stdio.h>
+
+/*
+ *  The parallel LCD driver against LiquidCrystal, on the pins of `GameController` and the host
+ *  board's HD44780 (see host/Board.hpp): both initialize the display, then print the same rows
+ *  over and over. Both must leave the display showing the last rows; then their bytes a second
+ *  are reported, on the board's clock, which moves by what the code waits for and by the cost
+ *  of each `digitalWrite`.
+ *
+ *      lcd_test
+ */
+
+#define CHECK(cond)                                                                           \
+    do {                                                                                      \
+        if (!(cond)) {                                                                        \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                   \
+            ++failures;                                                                       \
+        }                                                                                     \
+    } while (0)
+
+/*
+ *  LiquidCrystal 1.0.7 in 4-bit mode with RW tied low, as far as the sketch used it: its
+ *  initialization and its `send`, which goes through `digitalWrite` for every pin and waits
+ *  100 us after every nibble.
+ */
+class LiquidCrystal : public Print {
+public:
+    size_t write(const u8 value) override
+    {
+        send(value, HIGH);
+        return 1;
+    }
+    using Print::write;
+
+    void begin()
+    {
+        pinMode(GameController::RS_PIN, OUTPUT);
+        pinMode(GameController::ENABLE_PIN, OUTPUT);
+        for (const u8 pin : DATA_PINS)
+            pinMode(pin, OUTPUT);
+
+        delayMicroseconds(50000);
+        digitalWrite(GameController::RS_PIN, LOW);
+        digitalWrite(GameController::ENABLE_PIN, LOW);
+
+        write4bits(0x03);
+        delayMicroseconds(4500);
+        write4bits(0x03);
+        delayMicroseconds(4500);
+        write4bits(0x03);
+        delayMicroseconds(150);
+        write4bits(0x02);
+
+        command(LCD_FUNCTIONSET | LCD_4BITMODE | LCD_2LINE | LCD_5x8DOTS);
+        command(LCD_DISPLAYCONTROL | LCD_DISPLAYON);
+        clear();
+        command(LCD_ENTRYMODESET | LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT);
+    }
+    void clear()
+    {
+        command(LCD_CLEARDISPLAY);
+        delayMicroseconds(2000);
+    }
+    void setCursor(const u8 col, const u8 row)
+    {
+        command(u8(LCD_SETDDRAMADDR | (col + row * 0x40)));
+    }
+
+private:
+    void command(const u8 value) { send(value, LOW); }
+    void send(const u8 value, const u8 mode)
+    {
+        digitalWrite(GameController::RS_PIN, mode);
+        write4bits(u8(value >> 4));
+        write4bits(value);
+    }
+    void write4bits(const u8 value)
+    {
+        for (u8 i = 0; i < 4; ++i)
+            digitalWrite(DATA_PINS[i], (value >> i) & 0x01);
+        pulseEnable();
+    }
+    void pulseEnable()
+    {
+        digitalWrite(GameController::ENABLE_PIN, LOW);
+        delayMicroseconds(1);
+        digitalWrite(GameController::ENABLE_PIN, HIGH);
+        delayMicroseconds(1);
+        digitalWrite(GameController::ENABLE_PIN, LOW);
+        delayMicroseconds(100);
+    }
+
+    static constexpr u8 DATA_PINS[] = {
+        GameController::D4,
+        GameController::D5,
+        GameController::D6,
+        GameController::D7,
+    };
+};
+
+using LcdParallelController = LcdParallel<GameController::RS_PIN, GameController::ENABLE_PIN,
+    GameController::D4, GameController::D5, GameController::D6, GameController::D7>;
+
+/* Function declarations */
+template <typename Lcd> static double bytesPerSecond(Lcd&);
+static void begin(LiquidCrystal&);
+static void begin(LcdParallelController&);
+
+/* Times the rows are printed */
+static constexpr u32 REPEATS = 200;
+
+static int failures = 0;
+
+int main()
+{
+    Board::reset();
+    LiquidCrystal liquidCrystal;
+    const double liquidCrystalRate = bytesPerSecond(liquidCrystal);
+
+    Board::reset();
+    LcdParallelController lcdParallel;
+    const double lcdParallelRate = bytesPerSecond(lcdParallel);
+
+    CHECK(lcdParallelRate > liquidCrystalRate);
+    printf("%-14s %10.0f B/s\n", "LiquidCrystal", liquidCrystalRate);
+    printf("%-14s %10.0f B/s, x%.2f\n", "LcdParallel", lcdParallelRate,
+        lcdParallelRate / liquidCrystalRate);
+
+    printf("lcd_test: %d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
+
+/* The rows as a frame of the game prints them, a cursor move then the text */
+template <typename Lcd> double bytesPerSecond(Lcd& lcd)
+{
+    begin(lcd);
+
+    const u32 beginUs = Board::nowUs();
+    const u32 beginBytes = Board::lcdBusBytes();
+    char rows[Board::LCD_ROWS][Board::LCD_COLS + 1];
+    for (u32 i = 0; i < REPEATS; ++i) {
+        snprintf(rows[0], sizeof(rows[0]), "%-8s%8u", "Score", i);
+        snprintf(rows[1], sizeof(rows[1]), "%-8s%8u", "Reviews", REPEATS - i);
+        for (u8 row = 0; row < Board::LCD_ROWS; ++row) {
+            lcd.setCursor(0, row);
+            lcd.print(rows[row]);
+        }
+    }
+    const u32 us = Board::nowUs() - beginUs;
+    const u32 bytes = Board::lcdBusBytes() - beginBytes;
+
+    CHECK(bytes == REPEATS * Board::LCD_ROWS * (1 + Board::LCD_COLS));
+    for (u8 row = 0; row < Board::LCD_ROWS; ++row) {
+        char shown[4 * Board::LCD_COLS + 1];
+        Board::lcdRow(row, shown);
+        CHECK(strcmp(shown, rows[row]) == 0);
+    }
+    return bytes * 1e6 / us;
+}
+
+void begin(LiquidCrystal& lcd) { lcd.begin(); }
+
+void begin(LcdParallelController& lcd)
+{
+    lcd.beginTwoLines();
+    while (!lcd.poll())
+        Board::advanceTo(Board::nowUs() + 10);
+}
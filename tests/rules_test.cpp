@@ -0,0 +1,165 @@
+#include "Board.hpp"
+#include "Buzzer.hpp"
+#include "GameRules.hpp"
+#include "Replay.hpp"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ *  The game modes side by side (see GameRules.hpp): the sketch builds `gameUpdate` for every
+ *  mode, and each of them plays a game on the host board, up to the same level, without a
+ *  mistake. The games start at the same time, so they play the same tiles; only the rules
+ *  differ. For each mode, reports the size of its `gameUpdate` in this binary (host code, as
+ *  nm has it) and the time a frame of the game takes, the whole controller's update.
+ *
+ *      rules_test
+ */
+
+using Direction = JoystickController::Direction;
+using Press = JoystickController::Press;
+
+#define CHECK(cond)                                                                           \
+    do {                                                                                      \
+        if (!(cond)) {                                                                        \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                   \
+            ++failures;                                                                       \
+        }                                                                                     \
+    } while (0)
+
+struct Run {
+    u32 frames;
+    double nsPerFrame;
+    u8 level;
+};
+
+/* Function declarations */
+template <typename Rules> static void report(const char* name, const char* self);
+template <typename Rules> static Run play();
+static Input autopilot(const GameController&);
+static long codeSize(const char* self, const char* rules);
+
+/* The games end once past this level */
+static constexpr u8 LAST_LEVEL = 10;
+/* An input every so many ms, as a quick player's */
+static constexpr u32 INPUT_EVERY = 50;
+static constexpr u32 START_MS = 1000;
+static constexpr u32 GAMES = 4;
+
+static int failures = 0;
+
+int main(const int, char** const argv)
+{
+    printf("%-10s %10s %8s %12s\n", "mode", "code", "frames", "time");
+    report<GameRules::Classic>("Classic", argv[0]);
+    report<GameRules::Speed>("Speed", argv[0]);
+    report<GameRules::Hardcore>("Hardcore", argv[0]);
+    report<GameRules::Zen>("Zen", argv[0]);
+
+    printf("rules_test: %d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
+
+template <typename Rules> void report(const char* const name, const char* const self)
+{
+    Run best = {};
+    for (u32 game = 0; game < GAMES; ++game) {
+        const Run run = play<Rules>();
+        CHECK(run.level == LAST_LEVEL + 1);
+        if (game == 0 || run.nsPerFrame < best.nsPerFrame)
+            best = run;
+    }
+
+    const long size = codeSize(self, name);
+    char code[24] = "?";
+    if (size > 0)
+        snprintf(code, sizeof(code), "%ld B", size);
+    printf("%-10s %10s %8u %9.1f ns/frame\n", name, code, best.frames, best.nsPerFrame);
+}
+
+/* On a board of its own, left idle */
+template <typename Rules> Run play()
+{
+    Board::reset();
+    GameController gc;
+    gc.init();
+    Board::runInterrupts();
+
+    Board::advanceTo(START_MS * 1000);
+    gc.state = GameController::gameState<Rules>(millis());
+    const auto game = gc.state.updateFunc;
+
+    Run run = {};
+    std::chrono::steady_clock::duration spent {};
+    for (u32 frameTs = START_MS; gc.state.updateFunc == game
+         && gc.state.params.game.level <= LAST_LEVEL;
+         frameTs += Replay::FRAME_MS) {
+        Board::advanceTo(frameTs * 1000);
+        Input input = { millis(), micros(), Press::None, Direction::None, false };
+        if (input.currentTs % INPUT_EVERY == 0)
+            input = autopilot(gc);
+
+        const auto begin = std::chrono::steady_clock::now();
+        gc.update(input);
+        spent += std::chrono::steady_clock::now() - begin;
+
+        Board::runInterrupts();
+        ++run.frames;
+    }
+
+    Buzzer::silence();
+    run.level = gc.state.updateFunc == game ? gc.state.params.game.level : 0;
+    run.nsPerFrame = double(std::chrono::duration_cast<std::chrono::nanoseconds>(spent).count())
+        / run.frames;
+    return run;
+}
+
+/*
+ *  A step towards the next tile to take, or a press on it. While the level shows, the game
+ *  ignores the inputs.
+ */
+Input autopilot(const GameController& gc)
+{
+    const auto& params = gc.state.params.game;
+    const u8 tile = gc.levelOrder.buffers[gc.levelOrder.front][params.captured];
+    const GameController::Position target = { i8(tile / GameController::MATRIX_SIZE),
+        i8(tile % GameController::MATRIX_SIZE) };
+    const auto player = params.player;
+
+    Input input = { millis(), micros(), Press::None, Direction::None, false };
+    if (player.x < target.x)
+        input.joyDir = Direction::Left;
+    else if (player.x > target.x)
+        input.joyDir = Direction::Right;
+    else if (player.y < target.y)
+        input.joyDir = Direction::Up;
+    else if (player.y > target.y)
+        input.joyDir = Direction::Down;
+    else
+        input.joyPress = Press::Short;
+    return input;
+}
+
+/* The bytes of `gameUpdate<Rules>` in the binary at `self`, its cold parts included, or -1 */
+long codeSize(const char* const self, const char* const rules)
+{
+    const std::string command = std::string("nm -C -S --defined-only ") + self + " 2>/dev/null";
+    FILE* const nm = popen(command.c_str(), "r");
+    if (nm == nullptr)
+        return -1;
+
+    const std::string symbol = std::string(" gameUpdate<GameRules::") + rules + ">(";
+    long size = -1;
+    char line[512];
+    while (fgets(line, sizeof(line), nm) != nullptr) {
+        unsigned long address, symbolSize;
+        char type;
+        int name;
+        if (sscanf(line, "%lx %lx %c %n", &address, &symbolSize, &type, &name) == 3
+            && strstr(line + name, symbol.c_str()) != nullptr)
+            size = max(size, 0L) + long(symbolSize);
+    }
+
+    pclose(nm);
+    return size;
+}
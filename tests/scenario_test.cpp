@@ -0,0 +1,199 @@
+#include "Replay.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ *  Replays a recorded input scenario (in scenarios/, see Replay.hpp) on the whole game, on the
+ *  host board (see host/Board.hpp), and checks its display traffic against the scenario's
+ *  golden trace (in golden/):
+ *  - no frame may put more bytes on the LCD or the matrix bus than it does in the golden
+ *    trace, and neither may the whole run;
+ *  - no state may take longer to answer input (the 95th percentile of its input-to-photon
+ *    latency, as the board measures it) than in the golden trace;
+ *  - the game must go to sleep and be awake again at the same times as in the golden trace;
+ *  - the displays must show the same as in the golden trace at every snapshot.
+ *
+ *  Every run also reports the latency percentiles of the states that got input, and the most
+ *  stack each state used. On the host board, only the waits of the code take time: the
+ *  latencies are those of the display writes, to the board's log2 buckets (see
+ *  LatencyMonitor.hpp). The stack is the host's (see `Board::STACK_BYTES`).
+ *
+ *      scenario_test <scenario> <golden>            checks a run against its golden trace
+ *      scenario_test --record <scenario> <golden>   writes the golden trace of a run
+ */
+
+using namespace Replay;
+
+/* Function declarations */
+static bool readTrace(const char* path, Trace&);
+static void writeTrace(const char* path, const Trace&);
+static bool check(const Trace& trace, const Trace& golden);
+static void printStates(const Trace&);
+
+static GameController gameController;
+
+int main(const int argc, char** const argv)
+{
+    const bool record = argc == 4 && std::string(argv[1]) == "--record";
+    if (argc != 3 && !record) {
+        fprintf(stderr, "usage: %s [--record] <scenario> <golden>\n", argv[0]);
+        return 2;
+    }
+
+    const char* const scenarioPath = argv[argc - 2];
+    const char* const goldenPath = argv[argc - 1];
+    const auto trace = run(gameController, readScenario(scenarioPath));
+
+    if (record) {
+        writeTrace(goldenPath, trace);
+        printf("%s: recorded, LCD %u B, matrix %u B\n", scenarioPath, trace.total.lcdBytes,
+            trace.total.matrixBytes);
+        printStates(trace);
+        return 0;
+    }
+
+    Trace golden;
+    if (!readTrace(goldenPath, golden)) {
+        fprintf(stderr, "%s: no golden trace, record one with `make golden`\n", goldenPath);
+        return 1;
+    }
+
+    const bool ok = check(trace, golden);
+    printf("%s: %s, LCD %u B (golden %u B), matrix %u B (golden %u B)\n", scenarioPath,
+        ok ? "ok" : "FAILED", trace.total.lcdBytes, golden.total.lcdBytes,
+        trace.total.matrixBytes, golden.total.matrixBytes);
+    printStates(trace);
+    return ok ? 0 : 1;
+}
+
+bool readTrace(const char* const path, Trace& trace)
+{
+    FILE* const file = fopen(path, "r");
+    if (file == nullptr)
+        return false;
+
+    char line[128], name[64];
+    unsigned ts, lcdBytes, matrixBytes, p50Us, p95Us, maxUs, inputs, asleepUs, awakeUs;
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        if (sscanf(line, "frame %u lcd %u matrix %u", &ts, &lcdBytes, &matrixBytes) == 3)
+            trace.frames[ts] = { lcdBytes, matrixBytes };
+        else if (sscanf(line, "total lcd %u matrix %u", &lcdBytes, &matrixBytes) == 2)
+            trace.total = { lcdBytes, matrixBytes };
+        else if (sscanf(line, "latency p50 %u p95 %u max %u inputs %u %63[^\n]", &p50Us,
+                     &p95Us, &maxUs, &inputs, name)
+            == 5)
+            trace.latencies[name] = { p50Us, p95Us, maxUs, inputs };
+        else if (sscanf(line, "sleep %u awake %u", &asleepUs, &awakeUs) == 2)
+            trace.sleeps.push_back({ asleepUs, awakeUs });
+        else if (strncmp(line, "snapshot", 8) == 0)
+            trace.snapshots.emplace_back(line);
+        else if (line[0] != '#' && !trace.snapshots.empty())
+            trace.snapshots.back() += line;
+    }
+
+    fclose(file);
+    return true;
+}
+
+void writeTrace(const char* const path, const Trace& trace)
+{
+    FILE* const file = fopen(path, "w");
+    if (file == nullptr) {
+        perror(path);
+        exit(2);
+    }
+
+    fputs("# Written by `make golden`: the bytes put on each display bus by every frame that\n"
+          "# wrote to one, the input-to-photon latency (us) of each state that got input,\n"
+          "# when the game went to sleep and was awake again (us), and what the displays\n"
+          "# showed at the snapshots\n",
+        file);
+    for (const auto& frame : trace.frames) {
+        fprintf(file, "frame %u lcd %u matrix %u\n", frame.first, frame.second.lcdBytes,
+            frame.second.matrixBytes);
+    }
+    fprintf(file, "total lcd %u matrix %u\n", trace.total.lcdBytes, trace.total.matrixBytes);
+    for (const auto& state : trace.latencies) {
+        const auto& latency = state.second;
+        fprintf(file, "latency p50 %u p95 %u max %u inputs %u %s\n", latency.p50Us,
+            latency.p95Us, latency.maxUs, latency.inputs, state.first.c_str());
+    }
+    for (const auto& sleep : trace.sleeps)
+        fprintf(file, "sleep %u awake %u\n", sleep.asleepUs, sleep.awakeUs);
+    for (const auto& snapshot : trace.snapshots)
+        fputs(snapshot.c_str(), file);
+
+    fclose(file);
+}
+
+bool check(const Trace& trace, const Trace& golden)
+{
+    bool ok = true;
+
+    for (const auto& frame : trace.frames) {
+        const auto goldenFrame = golden.frames.find(frame.first);
+        const Traffic budget
+            = goldenFrame != golden.frames.end() ? goldenFrame->second : Traffic { 0, 0 };
+        if (frame.second.lcdBytes > budget.lcdBytes
+            || frame.second.matrixBytes > budget.matrixBytes) {
+            printf("frame at %u ms: LCD %u B, matrix %u B, over the golden %u B and %u B\n",
+                frame.first, frame.second.lcdBytes, frame.second.matrixBytes, budget.lcdBytes,
+                budget.matrixBytes);
+            ok = false;
+        }
+    }
+
+    if (trace.total.lcdBytes > golden.total.lcdBytes
+        || trace.total.matrixBytes > golden.total.matrixBytes) {
+        printf("the run is over its golden budget\n");
+        ok = false;
+    }
+
+    for (const auto& state : trace.latencies) {
+        const auto goldenState = golden.latencies.find(state.first);
+        const u32 bound
+            = goldenState != golden.latencies.end() ? goldenState->second.p95Us : 0;
+        if (state.second.p95Us > bound) {
+            printf("%s answers input in %u us (p95), over the golden %u us\n",
+                state.first.c_str(), state.second.p95Us, bound);
+            ok = false;
+        }
+    }
+
+    for (size_t i = 0; i < max(trace.sleeps.size(), golden.sleeps.size()); ++i) {
+        const Sleep none = { 0, 0 };
+        const auto& sleep = i < trace.sleeps.size() ? trace.sleeps[i] : none;
+        const auto& goldenSleep = i < golden.sleeps.size() ? golden.sleeps[i] : none;
+        if (sleep.asleepUs != goldenSleep.asleepUs || sleep.awakeUs != goldenSleep.awakeUs) {
+            printf("sleep %zu: from %u us to %u us, the golden trace has %u us to %u us\n", i,
+                sleep.asleepUs, sleep.awakeUs, goldenSleep.asleepUs, goldenSleep.awakeUs);
+            ok = false;
+        }
+    }
+
+    if (trace.snapshots.size() != golden.snapshots.size()) {
+        printf("%zu snapshots, the golden trace has %zu\n", trace.snapshots.size(),
+            golden.snapshots.size());
+        ok = false;
+    }
+    for (size_t i = 0; i < trace.snapshots.size() && i < golden.snapshots.size(); ++i) {
+        if (trace.snapshots[i] != golden.snapshots[i]) {
+            printf("expected:\n%sgot:\n%s", golden.snapshots[i].c_str(),
+                trace.snapshots[i].c_str());
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+void printStates(const Trace& trace)
+{
+    for (const auto& state : trace.latencies) {
+        const auto& latency = state.second;
+        printf("    %-14s p50 %6u us, p95 %6u us, max %6u us, %3u inputs\n",
+            state.first.c_str(), latency.p50Us, latency.p95Us, latency.maxUs, latency.inputs);
+    }
+    for (const auto& state : trace.stackBytes)
+        printf("    %-14s stack %5u B\n", state.first.c_str(), state.second);
+}
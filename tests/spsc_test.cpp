@@ -0,0 +1,113 @@
+#include "utils.hpp"
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+
+/*
+ *  Stress test of `SpscQueue`, with a thread in place of the main loop and another in place of
+ *  the ISR. Its barriers only order the compiler, which is enough on the AVR and on the x86's
+ *  stores, but not on weaker hosts: there, a failure here is not a failure on the target.
+ *
+ *  Both sides yield when they cannot go on, so that the test also runs on a single core.
+ */
+
+#define CHECK(cond)                                                                           \
+    do {                                                                                      \
+        if (!(cond)) {                                                                        \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                   \
+            ++failures;                                                                       \
+        }                                                                                     \
+    } while (0)
+
+/* Function declarations */
+static void checkPushPop();
+static void checkPublish();
+
+static int failures = 0;
+
+int main()
+{
+    checkPushPop();
+    checkPublish();
+
+    printf("spsc_test: %d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
+
+/* Every value comes out once, in order, through a queue that is mostly full or empty */
+void checkPushPop()
+{
+    static constexpr u32 VALUES = 1000000;
+    static Tiny::SpscQueue<u32, 8> queue;
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::thread producer([] {
+        for (u32 i = 0; i < VALUES;) {
+            if (queue.push(i))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    u32 expected = 0, outOfOrder = 0;
+    while (expected < VALUES) {
+        u32 value;
+        if (queue.pop(value)) {
+            outOfOrder += value != expected;
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    const auto end = std::chrono::steady_clock::now();
+
+    CHECK(outOfOrder == 0);
+    CHECK(queue.empty());
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+    printf("%-24s %8lld ms for %u values\n", "push/pop", (long long)ms, VALUES);
+}
+
+/* Records filled ahead of `tail` and published together are never seen partly written */
+void checkPublish()
+{
+    static constexpr u32 RECORDS = 200000;
+    static constexpr u8 RECORD_SIZE = 5;
+    static Tiny::SpscQueue<u8, 64> queue;
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::thread producer([] {
+        for (u32 record = 0; record < RECORDS;) {
+            if (queue.space() < RECORD_SIZE) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (u8 i = 0; i < RECORD_SIZE; ++i)
+                queue.ahead(i) = u8(record + i);
+            queue.publish(RECORD_SIZE);
+            ++record;
+        }
+    });
+
+    u32 torn = 0;
+    for (u32 record = 0; record < RECORDS;) {
+        if (queue.size() < RECORD_SIZE) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (u8 i = 0; i < RECORD_SIZE; ++i) {
+            u8 value = 0;
+            queue.pop(value);
+            torn += value != u8(record + i);
+        }
+        ++record;
+    }
+    producer.join();
+    const auto end = std::chrono::steady_clock::now();
+
+    CHECK(torn == 0);
+    CHECK(queue.empty());
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+    printf("%-24s %8lld ms for %u records\n", "publish", (long long)ms, RECORDS);
+}
@@ -0,0 +1,116 @@
+#include "Board.hpp"
+#include "Buzzer.hpp"
+#include "MatrixGrayscale.hpp"
+#include "Replay.hpp"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+/*
+ *  Runs many independent games on a pool of threads, each thread a board of its own (see
+ *  host/Board.hpp), and reports how many games a second go through for each number of
+ *  threads, from one up to the host's cores (at least two). Game `i` replays scenario
+ *  `i % n` of the `n` given, its inputs `i` ms late so that it draws other tiles (the seed is
+ *  the time the game starts). Every game must trace the same, whichever thread ran it after
+ *  whichever games.
+ *
+ *      throughput_test <games> <scenario>...
+ */
+
+using namespace Replay;
+
+/* Function declarations */
+static Trace play(const std::vector<Event>& scenario, u32 delayMs);
+static double gamesPerSecond(u32 numThreads, const std::vector<std::vector<Event>>& scenarios,
+    std::vector<Trace>& traces);
+static bool same(const Trace&, const Trace&);
+
+int main(const int argc, char** const argv)
+{
+    if (argc < 3 || atoi(argv[1]) <= 0) {
+        fprintf(stderr, "usage: %s <games> <scenario>...\n", argv[0]);
+        return 2;
+    }
+
+    const auto numGames = u32(atoi(argv[1]));
+    std::vector<std::vector<Event>> scenarios;
+    for (int i = 2; i < argc; ++i)
+        scenarios.push_back(readScenario(argv[i]));
+
+    const u32 numCores = max(std::thread::hardware_concurrency(), 1u);
+    std::vector<Trace> firstTraces(numGames);
+    const double firstRate = gamesPerSecond(1, scenarios, firstTraces);
+    printf("%u games, %u core(s)\n", numGames, numCores);
+    printf("%3u thread(s) %10.1f games/s\n", 1u, firstRate);
+
+    int failures = 0;
+    for (u32 numThreads = 2; numThreads <= max(numCores, 2u); numThreads *= 2) {
+        std::vector<Trace> traces(numGames);
+        const double rate = gamesPerSecond(numThreads, scenarios, traces);
+        printf("%3u thread(s) %10.1f games/s, x%.2f\n", numThreads, rate, rate / firstRate);
+
+        for (u32 game = 0; game < numGames; ++game) {
+            if (!same(traces[game], firstTraces[game])) {
+                printf("game %u traced otherwise on %u threads\n", game, numThreads);
+                ++failures;
+                break;
+            }
+        }
+    }
+
+    printf("throughput_test: %d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
+
+/* On the calling thread's board, left idle for the next game */
+Trace play(const std::vector<Event>& scenario, const u32 delayMs)
+{
+    std::vector<Event> events = scenario;
+    for (auto& event : events)
+        event.ts += delayMs;
+
+    Board::reset();
+    GameController gc;
+    const auto trace = run(gc, events);
+
+    Buzzer::silence();
+    if (MatrixGrayscale::isActive())
+        MatrixGrayscale::end(gc.matrix.controller);
+    return trace;
+}
+
+double gamesPerSecond(const u32 numThreads, const std::vector<std::vector<Event>>& scenarios,
+    std::vector<Trace>& traces)
+{
+    std::atomic<u32> nextGame(0);
+    const auto work = [&]() {
+        for (u32 game; (game = nextGame++) < traces.size();)
+            traces[game] = play(scenarios[game % scenarios.size()], game);
+    };
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (u32 i = 0; i < numThreads; ++i)
+        pool.emplace_back(work);
+    for (auto& thread : pool)
+        thread.join();
+    const auto end = std::chrono::steady_clock::now();
+
+    return double(traces.size()) / std::chrono::duration<double>(end - begin).count();
+}
+
+bool same(const Trace& a, const Trace& b)
+{
+    if (a.total.lcdBytes != b.total.lcdBytes || a.total.matrixBytes != b.total.matrixBytes
+        || a.frames.size() != b.frames.size() || a.snapshots != b.snapshots)
+        return false;
+
+    for (auto i = a.frames.begin(), j = b.frames.begin(); i != a.frames.end(); ++i, ++j) {
+        if (i->first != j->first || i->second.lcdBytes != j->second.lcdBytes
+            || i->second.matrixBytes != j->second.matrixBytes)
+            return false;
+    }
+    return true;
+}
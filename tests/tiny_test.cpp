@@ -0,0 +1,294 @@
+#include "utils.hpp"
+#include <chrono>
+#include <stdio.h>
+
+/*
+ *  Checks of the algorithms in utils.hpp, run on the host (see the Makefile), and their cost
+ *  per call there. The uniformity checks are chi-squared tests at the 0.1% level, with fixed
+ *  seeds so that a run is reproducible.
+ */
+
+#define CHECK(cond)                                                                           \
+    do {                                                                                      \
+        if (!(cond)) {                                                                        \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                   \
+            ++failures;                                                                       \
+        }                                                                                     \
+    } while (0)
+
+/* Function declarations */
+static double chiSquared(const u32* counts, size_t numCells, double expected);
+template <size_t N> static bool isPermutation(const Tiny::Array<u8, N>&);
+template <typename Callable> static void timeCalls(const char* name, u32 calls, Callable call);
+static void checkSwapIotaFind();
+static void checkStaticVector();
+static void checkCrc8();
+static void checkRandomBelow();
+static void checkShuffle();
+static void checkShufflePrefix();
+static void timeAll();
+
+static int failures = 0;
+
+/* Keeps the timed calls from being optimized out */
+static volatile u32 sink;
+
+int main()
+{
+    checkSwapIotaFind();
+    checkStaticVector();
+    checkCrc8();
+    checkRandomBelow();
+    checkShuffle();
+    checkShufflePrefix();
+    timeAll();
+
+    printf("tiny_test: %d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
+
+/* Pearson's statistic of `counts` against the same expected count in every cell */
+double chiSquared(const u32* counts, const size_t numCells, const double expected)
+{
+    double sum = 0;
+    for (size_t i = 0; i < numCells; ++i) {
+        const double diff = counts[i] - expected;
+        sum += diff * diff / expected;
+    }
+    return sum;
+}
+
+template <size_t N> bool isPermutation(const Tiny::Array<u8, N>& array)
+{
+    bool seen[N] = {};
+    for (const auto el : array) {
+        if (el >= N || seen[el])
+            return false;
+        seen[el] = true;
+    }
+    return true;
+}
+
+template <typename Callable> void timeCalls(const char* name, const u32 calls, Callable call)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < calls; ++i)
+        call(i);
+    const auto end = std::chrono::steady_clock::now();
+
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    printf("%-24s %8.1f ns/call\n", name, double(ns) / calls);
+}
+
+void checkSwapIotaFind()
+{
+    int x = 1, y = 2;
+    Tiny::swap(x, y);
+    CHECK(x == 2 && y == 1);
+
+    Tiny::Array<u8, 5> array;
+    Tiny::iota(array);
+    for (u8 i = 0; i < 5; ++i)
+        CHECK(array[i] == i);
+
+    const auto equal = [](const u8 el, const u8 value) { return el == value; };
+    CHECK(Tiny::find(array, u8(3), equal) == 3);
+    CHECK(Tiny::find(array, u8(0), equal) == 0);
+    CHECK(Tiny::find(array, u8(7), equal) == 5);
+
+    /* The first match wins */
+    array[4] = 1;
+    CHECK(Tiny::find(array, u8(1), equal) == 1);
+}
+
+/* Fills up to its capacity, then refuses more; iterates what was pushed, in order */
+void checkStaticVector()
+{
+    Tiny::StaticVector<u16, 4> vector;
+    CHECK(vector.size() == 0 && !vector.full() && vector.begin() == vector.end());
+
+    for (u16 i = 0; i < 4; ++i) {
+        CHECK(vector.push(u16(100 + i)));
+        CHECK(vector.size() == i + 1);
+    }
+    CHECK(vector.full());
+    CHECK(!vector.push(999));
+    CHECK(vector.size() == 4 && vector[3] == 103);
+
+    u16 expected = 100;
+    for (auto& el : vector) {
+        CHECK(el == expected++);
+        el = u16(el * 2);
+    }
+    CHECK(expected == 104);
+
+    const auto& constVector = vector;
+    u32 sum = 0;
+    for (const auto el : constVector)
+        sum += el;
+    CHECK(sum == 2 * (100 + 101 + 102 + 103));
+
+    vector.clear();
+    CHECK(vector.size() == 0 && !vector.full() && vector.begin() == vector.end());
+    CHECK(vector.push(7) && vector[0] == 7 && vector.size() == 1);
+}
+
+void checkCrc8()
+{
+    /* The check value of CRC-8 with polynomial 0x07 and no final xor */
+    const char check[] = "123456789";
+    CHECK(Tiny::crc8(check, 9) == 0xF4);
+    CHECK(Tiny::crc8(check, 0) == 0);
+
+    /* A record followed by its CRC checks to 0, and any single flipped bit is caught */
+    u8 record[10];
+    memcpy(record, check, 9);
+    record[9] = Tiny::crc8(record, 9);
+    CHECK(Tiny::crc8(record, sizeof(record)) == 0);
+    for (u8 bit = 0; bit < 8 * sizeof(record); ++bit) {
+        record[bit / 8] ^= u8(1 << bit % 8);
+        CHECK(Tiny::crc8(record, sizeof(record)) != 0);
+        record[bit / 8] ^= u8(1 << bit % 8);
+    }
+}
+
+void checkRandomBelow()
+{
+    /* A zero seed would get the generator stuck on zero */
+    Tiny::Random zero(0);
+    CHECK(zero.state != 0 && zero.next() != 0);
+
+    Tiny::Random rng(12345);
+    for (u32 i = 0; i < 1000; ++i)
+        CHECK(rng.below(1) == 0);
+
+    static constexpr u32 DRAWS = 100000;
+    /* By degrees of freedom, `bound - 1` */
+    static constexpr double CRITICAL[] = { 0, 10.83, 13.82, 16.27, 18.47, 20.52, 22.46, 24.32,
+        26.12, 27.88 };
+    for (u32 bound = 2; bound <= 10; ++bound) {
+        u32 counts[10] = {};
+        for (u32 i = 0; i < DRAWS; ++i) {
+            const u32 value = rng.below(bound);
+            CHECK(value < bound);
+            if (value < bound)
+                ++counts[value];
+        }
+        CHECK(chiSquared(counts, bound, double(DRAWS) / bound) < CRITICAL[bound - 1]);
+    }
+
+    /* `next() % bound` would land below 2^30 half of the time, not a third */
+    static constexpr u32 WIDE = 0xC0000000;
+    u32 low = 0;
+    for (u32 i = 0; i < DRAWS; ++i)
+        low += rng.below(WIDE) < 0x40000000;
+    const u32 high = DRAWS - low;
+    CHECK(chiSquared(&low, 1, DRAWS / 3.0) + chiSquared(&high, 1, DRAWS * 2 / 3.0)
+        < CRITICAL[1]);
+}
+
+/* Each of the 24 orders of 4 elements is as likely */
+void checkShuffle()
+{
+    static constexpr u32 SHUFFLES = 240000;
+    u32 counts[4 * 4 * 4 * 4] = {};
+    Tiny::Random rng(2024);
+
+    for (u32 i = 0; i < SHUFFLES; ++i) {
+        Tiny::Array<u8, 4> array;
+        Tiny::iota(array);
+        Tiny::shuffle(array, rng);
+        CHECK(isPermutation(array));
+        ++counts[array[0] * 64 + array[1] * 16 + array[2] * 4 + array[3]];
+    }
+
+    u32 orders[24];
+    u8 numOrders = 0;
+    for (u32 cell = 0; cell < 256; ++cell) {
+        const u8 a = u8(cell / 64), b = u8(cell / 16 % 4);
+        const u8 c = u8(cell / 4 % 4), d = u8(cell % 4);
+        if (a != b && a != c && a != d && b != c && b != d && c != d)
+            orders[numOrders++] = counts[cell];
+        else
+            CHECK(counts[cell] == 0);
+    }
+    CHECK(numOrders == 24);
+    CHECK(chiSquared(orders, numOrders, SHUFFLES / 24.0) < 49.73);
+}
+
+/* A prefix of 2 extended to 3 is any of the 120 arrangements of 3 of 6 elements as likely */
+void checkShufflePrefix()
+{
+    static constexpr u32 SHUFFLES = 240000;
+    u32 counts[6 * 6 * 6] = {};
+    Tiny::Random rng(7);
+
+    for (u32 i = 0; i < SHUFFLES; ++i) {
+        Tiny::Array<u8, 6> array;
+        Tiny::iota(array);
+        Tiny::shufflePrefix(array, 0, 2, rng);
+        Tiny::shufflePrefix(array, 2, 3, rng);
+        CHECK(isPermutation(array));
+        ++counts[array[0] * 36 + array[1] * 6 + array[2]];
+    }
+
+    u32 arrangements[120];
+    u8 numArrangements = 0;
+    for (u32 cell = 0; cell < 216; ++cell) {
+        const u8 a = u8(cell / 36), b = u8(cell / 6 % 6), c = u8(cell % 6);
+        if (a != b && a != c && b != c)
+            arrangements[numArrangements++] = counts[cell];
+        else
+            CHECK(counts[cell] == 0);
+    }
+    CHECK(numArrangements == 120);
+    CHECK(chiSquared(arrangements, numArrangements, SHUFFLES / 120.0) < 173.6);
+
+    /* An empty range draws nothing and moves nothing */
+    Tiny::Array<u8, 6> array;
+    Tiny::iota(array);
+    const u32 state = rng.state;
+    Tiny::shufflePrefix(array, 3, 3, rng);
+    CHECK(rng.state == state);
+    for (u8 i = 0; i < 6; ++i)
+        CHECK(array[i] == i);
+}
+
+void timeAll()
+{
+    static constexpr u32 CALLS = 1000000;
+    Tiny::Random rng(1);
+    Tiny::Array<u8, 64> array;
+    Tiny::iota(array);
+    const auto equal = [](const u8 el, const u8 value) { return el == value; };
+
+    timeCalls("Random::next", CALLS, [&](u32) { sink = rng.next(); });
+    timeCalls("Random::below(3)", CALLS, [&](u32) { sink = rng.below(3); });
+    timeCalls("Random::below(33)", CALLS, [&](u32) { sink = rng.below(33); });
+    timeCalls("swap", CALLS, [&](const u32 i) {
+        Tiny::swap(array[i % 64], array[(i + 1) % 64]);
+        sink = array[0];
+    });
+    timeCalls("iota<64>", CALLS / 10, [&](u32) {
+        Tiny::iota(array);
+        sink = array[63];
+    });
+    timeCalls("find<64>", CALLS / 10, [&](const u32 i) {
+        sink = u32(Tiny::find(array, u8(i % 64), equal));
+    });
+    timeCalls("shuffle<64>", CALLS / 10, [&](u32) {
+        Tiny::shuffle(array, rng);
+        sink = array[0];
+    });
+    timeCalls("shufflePrefix<64>(0, 8)", CALLS / 10, [&](u32) {
+        Tiny::shufflePrefix(array, 0, 8, rng);
+        sink = array[0];
+    });
+
+    u8 record[18];
+    memset(record, 0x5A, sizeof(record));
+    timeCalls("crc8(18 bytes)", CALLS, [&](const u32 i) {
+        record[0] = u8(i);
+        sink = Tiny::crc8(record, sizeof(record));
+    });
+}
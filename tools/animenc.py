@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+Encoder for the matrix animations played by `MatrixAnimator`.
+
+Reads animation sources (`animations/*.txt`) and prints the `Animations.hpp` header:
+    tools/animenc.py animations/*.txt > Animations.hpp
+
+A source starts with `name`, `fps` and `loop` lines, followed by frames of 8 rows of 8 columns
+('#' lit, '.' off), separated by blank lines. Lines starting with ';' are comments.
+
+Every frame is encoded as an XOR delta against the previous one (the first against a blank
+matrix): a byte whose bit `r` is set when row `r` changed, followed by the XOR of each changed
+row. An unchanged frame costs one byte.
+"""
+
+import os
+import sys
+
+SIZE = 8
+
+
+def parse(path):
+    meta = {}
+    frames = []
+    rows = []
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith(";"):
+                continue
+            if ":" in line:
+                key, value = line.split(":", 1)
+                meta[key.strip()] = value.strip()
+                continue
+            if not line:
+                if rows:
+                    frames.append(rows)
+                    rows = []
+                continue
+            if len(line) != SIZE or set(line) - set("#."):
+                raise ValueError("%s: bad row '%s'" % (path, line))
+            rows.append(sum(1 << (SIZE - 1 - i) for i, c in enumerate(line) if c == "#"))
+    if rows:
+        frames.append(rows)
+
+    for i, frame in enumerate(frames):
+        if len(frame) != SIZE:
+            raise ValueError("%s: frame %d has %d rows" % (path, i, len(frame)))
+    return meta, frames
+
+
+def encode(frames):
+    data = []
+    previous = [0] * SIZE
+    for frame in frames:
+        mask = 0
+        deltas = []
+        for r in range(SIZE):
+            if frame[r] != previous[r]:
+                mask |= 1 << r
+                deltas.append(frame[r] ^ previous[r])
+        data.append(mask)
+        data.extend(deltas)
+        previous = frame
+    return data
+
+
+def main():
+    out = [
+        "/* Generated by tools/animenc.py from the animations/ sources, do not edit */",
+        "",
+        "#pragma once",
+        '#include "MatrixAnimator.hpp"',
+        "",
+    ]
+    for path in sys.argv[1:]:
+        meta, frames = parse(path)
+        name = meta["name"]
+        data = encode(frames)
+        raw = len(frames) * SIZE
+        out.append(
+            "/* %s: %d frames, %d bytes (%d raw) */"
+            % (os.path.basename(path), len(frames), len(data), raw)
+        )
+        out.append("static const u8 %s_DATA[] PROGMEM = {" % name)
+        for i in range(0, len(data), 8):
+            out.append("    " + " ".join("0x%02x," % b for b in data[i : i + 8]))
+        out.append("};")
+        frame_ms = round(1000 / int(meta["fps"]))
+        loop = "true" if meta.get("loop") == "yes" else "false"
+        out.append("static constexpr MatrixAnimator::Animation %s = {" % name)
+        out.append("    %s_DATA, %d, %d, %s," % (name, len(frames), frame_ms, loop))
+        out.append("};")
+        out.append("")
+    print("\n".join(out).rstrip())
+
+
+if __name__ == "__main__":
+    main()
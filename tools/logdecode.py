@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""
+Decoder for the binary log stream written by `Log.hpp`.
+
+Every record is `<id: u8> <timestamp: u32 us> <arguments>`, little-endian. The event table
+(level, name and format of every id) is read from `LogEvents.def`, the same file the firmware
+is built from.
+
+Usage:
+    stty -F /dev/ttyACM0 115200 raw && tools/logdecode.py < /dev/ttyACM0
+    tools/logdecode.py capture.bin --elf bin/remember.elf --chrome trace.json
+
+With `--elf`, `{=fn}` arguments (state functions) are resolved to symbol names via avr-nm.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import subprocess
+import sys
+
+EVENT_RE = re.compile(r'^LOG_EVENT\((\w+),\s*(\w+),\s*"((?:[^"\\]|\\.)*)"\)', re.M)
+PLACEHOLDER_RE = re.compile(r"\{=(u8|u16|u32|i8|i16|i32|fn)\}")
+FORMATS = {
+    "u8": "<B",
+    "u16": "<H",
+    "u32": "<I",
+    "i8": "<b",
+    "i16": "<h",
+    "i32": "<i",
+    "fn": "<H",
+}
+HEADER = struct.Struct("<BI")
+
+
+class Event:
+    def __init__(self, level, name, fmt):
+        self.level = level
+        self.name = name
+        self.fmt = fmt
+        self.types = PLACEHOLDER_RE.findall(fmt)
+        self.args = [struct.Struct(FORMATS[t]) for t in self.types]
+        self.size = sum(a.size for a in self.args)
+
+    def render(self, values, symbols):
+        it = iter(zip(self.types, values))
+
+        def sub(_):
+            kind, value = next(it)
+            if kind == "fn":
+                return symbols.get(value, "0x%04x" % (value * 2))
+            return str(value)
+
+        return PLACEHOLDER_RE.sub(sub, self.fmt)
+
+
+def load_events(path):
+    with open(path) as f:
+        text = f.read()
+    return [Event(*m.groups()) for m in EVENT_RE.finditer(text)]
+
+
+def load_symbols(elf):
+    """Map code word addresses (what the firmware logs for `{=fn}`) to function names"""
+    out = subprocess.run(
+        ["avr-nm", "-C", "--defined-only", elf], check=True, capture_output=True, text=True
+    ).stdout
+    symbols = {}
+    for line in out.splitlines():
+        parts = line.split(None, 2)
+        if len(parts) == 3 and parts[1] in "tT":
+            name = re.sub(r"\(.*", "", parts[2])
+            symbols[int(parts[0], 16) // 2] = name
+    return symbols
+
+
+def read_exact(stream, size):
+    data = b""
+    while len(data) < size:
+        chunk = stream.read(size - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def decode(stream, events):
+    """Yield (timestamp_us, event, values), unwrapping the 32-bit microsecond counter"""
+    last = 0
+    epoch = 0
+    while True:
+        header = read_exact(stream, HEADER.size)
+        if header is None:
+            return
+        event_id, ts = HEADER.unpack(header)
+        if event_id >= len(events):
+            raise ValueError("unknown event id %d, the stream is out of sync" % event_id)
+
+        event = events[event_id]
+        payload = read_exact(stream, event.size)
+        if payload is None:
+            return
+        values = []
+        pos = 0
+        for arg in event.args:
+            values.append(arg.unpack_from(payload, pos)[0])
+            pos += arg.size
+
+        if event.name == "Boot":
+            epoch += last
+        elif ts < last:
+            epoch += 1 << 32
+        last = ts
+        yield epoch + ts, event, values
+
+
+def chrome_trace(records, symbols):
+    trace = []
+    current = None
+    last_ts = 0
+    for ts, event, values in records:
+        last_ts = ts
+        if event.name == "Boot" and current:
+            trace.append(dict(current, dur=ts - current["ts"]))
+            current = None
+        if event.name == "StateEnter":
+            if current:
+                trace.append(dict(current, dur=ts - current["ts"]))
+            name = event.render(values, symbols).split(" ", 1)[1]
+            current = {"name": name, "cat": "state", "ph": "X", "ts": ts, "pid": 0, "tid": 0}
+        elif event.name == "LoopStats":
+            trace.append(
+                {
+                    "name": "loop",
+                    "ph": "C",
+                    "ts": ts,
+                    "pid": 0,
+                    "args": {"frames": values[0], "max_us": values[1]},
+                }
+            )
+        elif event.name == "BusTraffic":
+            trace.append(
+                {
+                    "name": "bus",
+                    "ph": "C",
+                    "ts": ts,
+                    "pid": 0,
+                    "args": {"lcd_bytes": values[0], "matrix_bytes": values[2]},
+                }
+            )
+        elif event.name == "StackLow":
+            trace.append(
+                {
+                    "name": "free ram",
+                    "ph": "C",
+                    "ts": ts,
+                    "pid": 0,
+                    "args": {"bytes": values[1]},
+                }
+            )
+        else:
+            trace.append(
+                {
+                    "name": event.render(values, symbols),
+                    "cat": event.level.lower(),
+                    "ph": "i",
+                    "s": "g",
+                    "ts": ts,
+                    "pid": 0,
+                    "tid": 0,
+                }
+            )
+    if current:
+        trace.append(dict(current, dur=last_ts - current["ts"]))
+    return {"traceEvents": trace, "displayTimeUnit": "ms"}
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("input", nargs="?", default="-", help="capture file, '-' for stdin")
+    parser.add_argument("--events", default=os.path.join(root, "LogEvents.def"))
+    parser.add_argument("--elf", help="firmware ELF used to resolve {=fn} arguments")
+    parser.add_argument("--chrome", metavar="JSON", help="also write a Chrome trace")
+    args = parser.parse_args()
+
+    events = load_events(args.events)
+    symbols = load_symbols(args.elf) if args.elf else {}
+    stream = sys.stdin.buffer if args.input == "-" else open(args.input, "rb")
+
+    records = []
+    for ts, event, values in decode(stream, events):
+        print("%12.6f %-5s %s" % (ts / 1e6, event.level.upper(), event.render(values, symbols)))
+        sys.stdout.flush()
+        if args.chrome:
+            records.append((ts, event, values))
+
+    if args.chrome:
+        with open(args.chrome, "w") as f:
+            json.dump(chrome_trace(records, symbols), f)
+
+
+if __name__ == "__main__":
+    main()
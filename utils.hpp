@@ -1,13 +1,19 @@
 /*
  *  Minimal implementations of some STL components and some other utils:
  *      std::array,
+ *      a bounded vector and a FIFO to share with an ISR,
  *      std::pair,
  *      std::for_each,
- *      std::clamp
+ *      std::size,
+ *      std::clamp,
+ *      strlen (constexpr),
+ *      a seedable PRNG,
+ *      CRC-8
  */
 
 #pragma once
 #include "Arduino.h"
+#include <util/crc16.h>
 
 namespace Tiny {
 /* <array> */
@@ -29,12 +35,127 @@ public:
     T data[N];
 };
 
+/* Keeps the compiler from moving memory accesses across it */
+inline void compilerBarrier() { asm volatile("" ::: "memory"); }
+
+/* <vector> with a fixed capacity */
+template <typename T, u8 N> struct StaticVector {
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    constexpr StaticVector()
+        : data()
+        , count(0)
+    {
+    }
+
+    const T& operator[](const u8 i) const { return data[i]; }
+    T& operator[](const u8 i) { return data[i]; }
+    const_iterator begin() const { return &data[0]; }
+    iterator begin() { return &data[0]; }
+    const_iterator end() const { return &data[count]; }
+    iterator end() { return &data[count]; }
+    u8 size() const { return count; }
+    bool full() const { return count == N; }
+
+    /* Whether there was room for `value` */
+    bool push(const T& value)
+    {
+        if (full())
+            return false;
+
+        data[count++] = value;
+        return true;
+    }
+    void clear() { count = 0; }
+
+public:
+    T data[N];
+    u8 count;
+};
+
+/*
+ *  FIFO of up to `N` elements, `N` a power of two, shared by one producer and one consumer
+ *  that interrupt each other (the main loop and an ISR). The indices run freely and are masked
+ *  on access, so all `N` slots are used and the size is the difference of the indices.
+ *
+ *  The producer only writes `tail` and the consumer only `head`. Both are single bytes, so the
+ *  AVR loads and stores them atomically. The barriers keep the element accesses on the right
+ *  side of the index update that publishes or releases them.
+ *
+ *  The producer can also fill several elements ahead of `tail` and publish them together, so
+ *  the consumer never sees a partial record.
+ */
+template <typename T, u8 N> struct SpscQueue {
+public:
+    static_assert(N && (N & (N - 1)) == 0 && N <= 128, "The size must be a power of two");
+
+    constexpr SpscQueue()
+        : data()
+        , head(0)
+        , tail(0)
+    {
+    }
+
+    u8 size() const { return u8(tail - head); }
+    bool empty() const { return size() == 0; }
+
+    /* Producer side */
+    u8 space() const { return u8(N - size()); }
+    T& ahead(const u8 i) { return data[(tail + i) & MASK]; }
+    const T& back() const { return data[(tail - 1) & MASK]; }
+    void publish(const u8 count)
+    {
+        compilerBarrier();
+        tail = u8(tail + count);
+    }
+    bool push(const T& value)
+    {
+        if (!space())
+            return false;
+
+        ahead(0) = value;
+        publish(1);
+        return true;
+    }
+
+    /* Consumer side */
+    const T& front() const { return data[head & MASK]; }
+    void drop()
+    {
+        compilerBarrier();
+        head = u8(head + 1);
+    }
+    bool pop(T& value)
+    {
+        if (empty())
+            return false;
+
+        compilerBarrier();
+        value = front();
+        drop();
+        return true;
+    }
+    void clear() { head = tail; }
+
+    static constexpr u8 MASK = N - 1;
+
+public:
+    T data[N];
+    volatile u8 head;
+    volatile u8 tail;
+};
+
 /* <utility> */
 template <typename T, typename U> struct Pair {
     T first;
     U second;
 };
 
+/* <iterator> */
+template <typename T, size_t N> constexpr size_t size(const T (&)[N]) { return N; }
+
 /* <algorithm> */
 template <typename Container, typename Callable> void forEach(Container& cont, Callable call)
 {
@@ -42,22 +163,14 @@ template <typename Container, typename Callable> void forEach(Container& cont, C
         call(el);
 }
 
-template <typename T, typename U> T clamp(const T& x, const U& low, const U& high)
+template <typename T, typename U> constexpr T clamp(const T& x, const U& low, const U& high)
 {
-    if (x < low)
-        return low;
-    if (x > high)
-        return high;
-    return x;
+    return x < low ? T(low) : (x > high ? T(high) : x);
 }
 
-template <typename T> T clamp(const T& x, const Pair<T, T>& range)
+template <typename T> constexpr T clamp(const T& x, const Pair<T, T>& range)
 {
-    if (x < range.first)
-        return range.first;
-    if (x > range.second)
-        return range.second;
-    return x;
+    return clamp(x, range.first, range.second);
 }
 
 template <typename T> void swap(T& x, T& y)
@@ -74,10 +187,21 @@ template <typename T, size_t N> void iota(Array<T, N>& array)
         el = i++;
 }
 
-template <typename T, size_t N> void shuffle(Array<T, N>& array)
+/*
+ *  Fisher-Yates run front to back over [begin, end) only. If [0, begin) was drawn the same
+ *  way, [0, end) is a uniformly random arrangement of `end` of the elements, so a prefix can
+ *  be produced on demand and extended later, paying one draw per element.
+ */
+template <typename T, size_t N, typename Rng>
+void shufflePrefix(Array<T, N>& array, size_t begin, const size_t end, Rng& rng)
 {
-    for (size_t i = N - 1; i >= 1; --i)
-        Tiny::swap(array[i], array[size_t(random(i + 1))]);
+    for (; begin < end && begin < N - 1; ++begin)
+        Tiny::swap(array[begin], array[begin + size_t(rng.below(u32(N - begin)))]);
+}
+
+template <typename T, size_t N, typename Rng> void shuffle(Array<T, N>& array, Rng& rng)
+{
+    shufflePrefix(array, 0, N, rng);
 }
 
 template <typename T, typename U, typename Callable, size_t N>
@@ -91,16 +215,91 @@ size_t find(const Array<T, N>& arr, const U& value, Callable c)
     return N;
 }
 
+/* <random> */
+/* xorshift32: unlike `random()`, its whole state is the 32-bit seed */
+struct Random {
+public:
+    explicit Random(const u32 seed)
+        : state(seed ? seed : 0x2545F491)
+    {
+    }
+
+    u32 next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    /* Unbiased: draws are masked to the next power of two and rejected until below `bound` */
+    u32 below(const u32 bound)
+    {
+        u32 mask = bound - 1;
+        mask |= mask >> 1;
+        mask |= mask >> 2;
+        mask |= mask >> 4;
+        mask |= mask >> 8;
+        mask |= mask >> 16;
+
+        u32 value;
+        do
+            value = next() & mask;
+        while (value >= bound);
+
+        return value;
+    }
+
+public:
+    u32 state;
+};
+
+/* Copy of an object kept in program memory */
+template <typename T> T readPgm(const T* pgmAddr)
+{
+    T value;
+    memcpy_P(&value, pgmAddr, sizeof(T));
+    return value;
+}
+
+inline u8 crc8(const void* data, const size_t size)
+{
+    auto bytes = (const u8*)data;
+    u8 crc = 0;
+    for (size_t i = 0; i < size; ++i)
+        crc = _crc8_ccitt_update(crc, bytes[i]);
+    return crc;
+}
+
+/* <cstring>: `strlen` is only constexpr as a GCC builtin on constant strings */
+constexpr size_t length(const char* str) { return *str ? 1 + length(str + 1) : 0; }
+
 struct String {
     constexpr String(const char* ptr)
         : ptr(ptr)
-        , len(strlen(ptr))
+        , len(length(ptr))
     {
     }
 
     const char* ptr;
     size_t len;
 };
+
+/* Checks of the constexpr parts, so that a change that breaks them doesn't build */
+static_assert(length("") == 0 && String("Remember").len == 8, "Wrong string lengths");
+static_assert(clamp(-1, 0, 3) == 0 && clamp(2, 0, 3) == 2 && clamp(5, 0, 3) == 3,
+    "Wrong clamp");
+static_assert(clamp(u16(600), Pair<u16, u16> { 100, 500 }) == 500, "Wrong clamp to a range");
+static_assert(clamp(u8(200), int16_t(0), int16_t(100)) == 100, "Wrong clamp across types");
+static_assert(size("abc") == 4, "Wrong array size");
 }
 
 #define UNREACHABLE __builtin_unreachable()
+
+/*
+ *  The storage of the drivers' state, which belongs to the board they drive: a single one on
+ *  the AVR, a thread's own in the host tests (which define it as `thread_local`)
+ */
+#ifndef BOARD_LOCAL
+#define BOARD_LOCAL
+#endif